@@ -1,6 +1,6 @@
 #include "common.h"
 #include "addressUtilsByron.h"
-#include "keyDerivation.h"
+#include "derivationCache.h"
 #include "cbor.h"
 #include "cardano.h"
 #include "hash.h"
@@ -262,7 +262,7 @@ size_t deriveRawAddress(
 	{
 		extendedPublicKey_t extPubKey;
 
-		deriveExtendedPublicKey(pathSpec, &extPubKey);
+		derivationCache_getExtendedPublicKey(pathSpec, &extPubKey);
 
 		addressRootFromExtPubKey(
 		        &extPubKey,
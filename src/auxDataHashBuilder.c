@@ -46,7 +46,7 @@ The following macros and functions have dual purpose:
 
 __noinline_due_to_stack__
 static void blake2b_256_append_cbor_aux_data(
-        blake2b_256_context_t* hashCtx,
+        blake2b_256_buffered_context_t* hashCtx,
         uint8_t type, uint64_t value,
         bool trace
 )
@@ -56,11 +56,11 @@ static void blake2b_256_append_cbor_aux_data(
 	if (trace) {
 		TRACE_BUFFER(buffer, size);
 	}
-	blake2b_256_append(hashCtx, buffer, size);
+	blake2b_256_buffered_append(hashCtx, buffer, size);
 }
 
 static void blake2b_256_append_buffer_aux_data(
-        blake2b_256_context_t* hashCtx,
+        blake2b_256_buffered_context_t* hashCtx,
         const uint8_t* buffer, size_t bufferSize,
         bool trace
 )
@@ -72,7 +72,7 @@ static void blake2b_256_append_buffer_aux_data(
 	if (trace) {
 		TRACE_BUFFER(buffer, bufferSize);
 	}
-	blake2b_256_append(hashCtx, buffer, bufferSize);
+	blake2b_256_buffered_append(hashCtx, buffer, bufferSize);
 }
 
 /* End of hash computation utilities. */
@@ -82,8 +82,8 @@ void auxDataHashBuilder_init(
 )
 {
 	TRACE("Serializing tx auxiliary data");
-	blake2b_256_init(&builder->auxDataHash);
-	blake2b_256_init(&builder->cVoteRegistrationData.payloadHash);
+	blake2b_256_buffered_init(&builder->auxDataHash);
+	blake2b_256_buffered_init(&builder->cVoteRegistrationData.payloadHash);
 
 	{
 		APPEND_CBOR(HC_AUX_DATA, CBOR_TYPE_ARRAY, 2);
@@ -292,7 +292,7 @@ void auxDataHashBuilder_cVoteRegistration_finalizePayload(aux_data_hash_builder_
 
 	ASSERT(outSize == CVOTE_REGISTRATION_PAYLOAD_HASH_LENGTH);
 	{
-		blake2b_256_finalize(&builder->cVoteRegistrationData.payloadHash, outBuffer, outSize);
+		blake2b_256_buffered_finalize(&builder->cVoteRegistrationData.payloadHash, outBuffer, outSize);
 	}
 }
 
@@ -345,7 +345,7 @@ void auxDataHashBuilder_finalize(aux_data_hash_builder_t* builder, uint8_t* outB
 
 	ASSERT(outSize == AUX_DATA_HASH_LENGTH);
 	{
-		blake2b_256_finalize(&builder->auxDataHash, outBuffer, outSize);
+		blake2b_256_buffered_finalize(&builder->auxDataHash, outBuffer, outSize);
 	}
 
 	builder->state = AUX_DATA_HASH_BUILDER_FINISHED;
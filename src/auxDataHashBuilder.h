@@ -44,13 +44,13 @@ typedef enum {
 
 typedef struct {
 	struct {
-		blake2b_256_context_t payloadHash;
+		blake2b_256_buffered_context_t payloadHash;
 		cvote_registration_format_t format;
 		uint16_t remainingDelegations;
 	} cVoteRegistrationData;
 
 	aux_data_hash_builder_state_t state;
-	blake2b_256_context_t auxDataHash;
+	blake2b_256_buffered_context_t auxDataHash;
 } aux_data_hash_builder_t;
 
 
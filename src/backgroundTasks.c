@@ -0,0 +1,92 @@
+#include "backgroundTasks.h"
+#include "io.h"
+#include "uiHelpers.h"
+
+static struct {
+	background_task_fn_t* tasks[BACKGROUND_TASKS_MAX];
+	size_t numTasks;
+	bool isSliceRunning;
+	// a UI callback that came during the running slice
+	background_callback_fn_t* deferredCallback;
+} scheduler;
+
+void backgroundTasks_reset()
+{
+	explicit_bzero(&scheduler, SIZEOF(scheduler));
+}
+
+void backgroundTasks_schedule(background_task_fn_t* task)
+{
+	ASSERT(task != NULL);
+	ASSERT(scheduler.numTasks < BACKGROUND_TASKS_MAX);
+
+	scheduler.tasks[scheduler.numTasks] = task;
+	scheduler.numTasks++;
+}
+
+static void _removeFirstTask()
+{
+	ASSERT(scheduler.numTasks > 0);
+	ASSERT(scheduler.numTasks <= BACKGROUND_TASKS_MAX);
+
+	for (size_t i = 1; i < scheduler.numTasks; i++) {
+		scheduler.tasks[i - 1] = scheduler.tasks[i];
+	}
+	scheduler.numTasks--;
+	scheduler.tasks[scheduler.numTasks] = NULL;
+}
+
+void backgroundTasks_runSlice()
+{
+	// handlers do their work themselves
+	if (io_state != IO_EXPECT_UI) return;
+	// called from a running slice (via a heartbeat)
+	if (scheduler.isSliceRunning) return;
+	if (scheduler.numTasks == 0) return;
+
+	background_task_fn_t* task = scheduler.tasks[0];
+
+	// if the task throws, the flag is cleared by the reset at the end of the instruction
+	scheduler.isSliceRunning = true;
+	const bool hasMoreWork = task();
+	scheduler.isSliceRunning = false;
+
+	// UI callbacks were deferred, nothing could have reset the tasks meanwhile
+	ASSERT(scheduler.numTasks > 0);
+	ASSERT(scheduler.tasks[0] == task);
+	if (!hasMoreWork) {
+		TRACE("Background task done");
+		_removeFirstTask();
+	}
+
+	if (scheduler.deferredCallback != NULL) {
+		background_callback_fn_t* callback = scheduler.deferredCallback;
+		scheduler.deferredCallback = NULL;
+
+		TRACE("Running deferred UI callback");
+		// the same handling as for the UI event the callback came with
+		TRY_CATCH_UI(callback());
+	}
+}
+
+bool backgroundTasks_isSliceRunning()
+{
+	return scheduler.isSliceRunning;
+}
+
+void backgroundTasks_deferCallback(background_callback_fn_t* callback)
+{
+	ASSERT(scheduler.isSliceRunning);
+	ASSERT(callback != NULL);
+	// only one confirmation or rejection per UI step (see uiCallback_confirm)
+	ASSERT(scheduler.deferredCallback == NULL);
+
+	scheduler.deferredCallback = callback;
+}
+
+#ifdef DEVEL
+size_t backgroundTasks_numTasks()
+{
+	return scheduler.numTasks;
+}
+#endif // DEVEL
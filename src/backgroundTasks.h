@@ -0,0 +1,45 @@
+#ifndef H_CARDANO_APP_BACKGROUND_TASKS
+#define H_CARDANO_APP_BACKGROUND_TASKS
+
+#include "common.h"
+
+// Work that does not depend on the user's decision (e.g. public key derivations)
+// can be done in small slices while the user is reviewing the screens,
+// so that little is left to do after the confirmation.
+//
+// A task must do a bounded amount of work per call (e.g. a single key derivation)
+// and return true iff there is more work left.
+//
+// Key derivations process UI events (see io_seproxyhal_io_heartbeat), so the user
+// might confirm or reject in the middle of a slice. Such a UI callback is deferred
+// until the slice ends, thus a task never runs nested in the work it does itself
+// and the instruction cannot end (e.g. by ui_idle) under a running task.
+// A slice must not write to NVM (it runs from a UI event), see xpubCache_store.
+typedef bool background_task_fn_t();
+
+typedef void background_callback_fn_t();
+
+#define BACKGROUND_TASKS_MAX 4
+
+// the tasks are dropped whenever an instruction starts or ends
+void backgroundTasks_reset();
+
+// the tasks are run one after another in the order they were scheduled
+void backgroundTasks_schedule(background_task_fn_t* task);
+
+// supposed to be called on UI events (ticker, display processed),
+// does nothing unless the app is waiting for the user
+void backgroundTasks_runSlice();
+
+bool backgroundTasks_isSliceRunning();
+
+// the callback is run as soon as the running slice ends
+void backgroundTasks_deferCallback(background_callback_fn_t* callback);
+
+#ifdef DEVEL
+size_t backgroundTasks_numTasks();
+
+void run_backgroundTasks_test();
+#endif // DEVEL
+
+#endif // H_CARDANO_APP_BACKGROUND_TASKS
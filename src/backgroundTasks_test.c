@@ -0,0 +1,126 @@
+#ifdef DEVEL
+
+#include "backgroundTasks.h"
+#include "io.h"
+#include "testUtils.h"
+
+static struct {
+	size_t numSlicesA;
+	size_t numSlicesB;
+	// to check the order of the tasks
+	char log[10];
+	size_t logSize;
+} testState;
+
+static void _log(char c)
+{
+	ASSERT(testState.logSize + 1 < SIZEOF(testState.log));
+	testState.log[testState.logSize] = c;
+	testState.logSize++;
+}
+
+// three slices
+static bool taskA()
+{
+	_log('a');
+	testState.numSlicesA++;
+	return testState.numSlicesA < 3;
+}
+
+// a single slice
+static bool taskB()
+{
+	_log('b');
+	testState.numSlicesB++;
+	return false;
+}
+
+static void callbackX()
+{
+	EXPECT_EQ(backgroundTasks_isSliceRunning(), false);
+	_log('x');
+}
+
+// the user confirms in the middle of the slice
+static bool taskC()
+{
+	_log('c');
+	EXPECT_EQ(backgroundTasks_isSliceRunning(), true);
+	backgroundTasks_deferCallback(callbackX);
+	_log('C');
+	return false;
+}
+
+static void testOrder()
+{
+	PRINTF("testcase_backgroundTasks\n");
+	explicit_bzero(&testState, SIZEOF(testState));
+	const io_state_t savedIoState = io_state;
+
+	backgroundTasks_reset();
+	backgroundTasks_schedule(taskA);
+	backgroundTasks_schedule(taskB);
+	EXPECT_EQ(backgroundTasks_numTasks(), 2);
+
+	// not waiting for the user
+	io_state = IO_EXPECT_NONE;
+	backgroundTasks_runSlice();
+	EXPECT_EQ(testState.logSize, 0);
+
+	io_state = IO_EXPECT_UI;
+	for (size_t i = 0; i < 6; i++) {
+		backgroundTasks_runSlice();
+	}
+	EXPECT_EQ(testState.logSize, 4);
+	EXPECT_EQ_BYTES(testState.log, "aaab", 4);
+	EXPECT_EQ(backgroundTasks_numTasks(), 0);
+
+	io_state = savedIoState;
+}
+
+static void testReset()
+{
+	PRINTF("testcase_backgroundTasks reset\n");
+	explicit_bzero(&testState, SIZEOF(testState));
+	const io_state_t savedIoState = io_state;
+
+	backgroundTasks_reset();
+	backgroundTasks_schedule(taskA);
+	io_state = IO_EXPECT_UI;
+	backgroundTasks_runSlice();
+	EXPECT_EQ(testState.numSlicesA, 1);
+
+	backgroundTasks_reset();
+	EXPECT_EQ(backgroundTasks_numTasks(), 0);
+	backgroundTasks_runSlice();
+	EXPECT_EQ(testState.numSlicesA, 1);
+
+	io_state = savedIoState;
+}
+
+static void testDeferredCallback()
+{
+	PRINTF("testcase_backgroundTasks deferred callback\n");
+	explicit_bzero(&testState, SIZEOF(testState));
+	const io_state_t savedIoState = io_state;
+
+	backgroundTasks_reset();
+	backgroundTasks_schedule(taskC);
+	io_state = IO_EXPECT_UI;
+	backgroundTasks_runSlice();
+	EXPECT_EQ(testState.logSize, 3);
+	EXPECT_EQ_BYTES(testState.log, "cCx", 3);
+	EXPECT_EQ(backgroundTasks_numTasks(), 0);
+	EXPECT_EQ(backgroundTasks_isSliceRunning(), false);
+
+	io_state = savedIoState;
+}
+
+void run_backgroundTasks_test()
+{
+	testOrder();
+	testReset();
+	testDeferredCallback();
+}
+
+#endif // DEVEL
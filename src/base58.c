@@ -15,13 +15,20 @@
 *  limitations under the License.
 ********************************************************************************/
 
-// This code is slightly modified version of Ripple's code
+// This code is based on Ripple's code, which divided the input by 58 one byte at a time
+// (kept as the reference in base58_test.c).
 
 #include "common.h"
 #include "base58.h"
 
 #define MAX_BUFFER_SIZE 124
 
+// the input is divided by 58^5, the largest power of 58 fitting into 32 bits,
+// in 32-bit limbs, yielding 5 digits per pass
+#define BASE58_DIGITS_PER_LIMB 5
+#define BASE58_LIMB_DIVISOR ((uint32_t) 58 * 58 * 58 * 58 * 58)
+#define MAX_LIMBS ((MAX_BUFFER_SIZE + 3) / 4)
+
 /* cspell:disable-next-line */
 static const char BASE58ALPHABET[] = "123456789ABCDEFGHJKLMNPQRSTUVWXYZabcdefghijkmnopqrstuvwxyz";
 
@@ -30,45 +37,56 @@ size_t base58_encode(
         char* outStr, size_t outMaxSize
 )
 {
-	uint8_t tmpBuffer[MAX_BUFFER_SIZE] = {0};
-	uint8_t buffer[MAX_BUFFER_SIZE * 2] = {0};
-	size_t startAt;
-	size_t zeroCount = 0;
+	uint32_t limbs[MAX_LIMBS] = {0};
+	char buffer[MAX_BUFFER_SIZE * 2] = {0};
 
-	ASSERT(inSize <= SIZEOF(tmpBuffer));
+	ASSERT(inSize <= MAX_BUFFER_SIZE);
 	ASSERT(outMaxSize < BUFFER_SIZE_PARANOIA);
 
-	memmove(tmpBuffer, inBuffer, inSize);
-
-	while ((zeroCount < inSize) && (tmpBuffer[zeroCount] == 0)) {
+	size_t zeroCount = 0;
+	while ((zeroCount < inSize) && (inBuffer[zeroCount] == 0)) {
 		++zeroCount;
 	}
-	size_t j = 2 * inSize;
-	startAt = zeroCount;
 
-	while (startAt < inSize) {
-		unsigned short remainder = 0;
-		size_t divLoop;
-		for (divLoop = startAt; divLoop < inSize; divLoop++) {
-			unsigned short digit256 = (unsigned short)(tmpBuffer[divLoop] & 0xff);
-			unsigned short tmpDiv = remainder * 256 + digit256;
-			tmpBuffer[divLoop] = (unsigned char)(tmpDiv / 58);
-			remainder = (tmpDiv % 58);
-		}
-		if (tmpBuffer[startAt] == 0) {
+	// the input as a big-endian number in base 2^32, padded with leading zeros
+	const size_t numLimbs = (inSize + 3) / 4;
+	ASSERT(numLimbs <= ARRAY_LEN(limbs));
+	const size_t padding = 4 * numLimbs - inSize;
+	for (size_t i = 0; i < inSize; i++) {
+		const size_t position = padding + i;
+		limbs[position / 4] |= (uint32_t) inBuffer[i] << (8 * (3 - position % 4));
+	}
+
+	// digits are written from the end of the buffer
+	size_t j = SIZEOF(buffer);
+	size_t startAt = 0;
+	while (startAt < numLimbs) {
+		if (limbs[startAt] == 0) {
 			++startAt;
+			continue;
+		}
+		uint32_t remainder = 0;
+		for (size_t i = startAt; i < numLimbs; i++) {
+			const uint64_t value = ((uint64_t) remainder << 32) | limbs[i];
+			const uint64_t quotient = value / BASE58_LIMB_DIVISOR;
+			limbs[i] = (uint32_t) quotient;
+			remainder = (uint32_t) (value - quotient * BASE58_LIMB_DIVISOR);
+		}
+		for (size_t k = 0; k < BASE58_DIGITS_PER_LIMB; k++) {
+			ASSERT((0 < j) && (j <= SIZEOF(buffer)));
+			buffer[--j] = BASE58ALPHABET[remainder % 58];
+			remainder /= 58;
 		}
-		ASSERT((0 < j) && (j <= SIZEOF(buffer)));
-		buffer[--j] = BASE58ALPHABET[remainder];
 	}
-	while ((j < (2 * inSize)) && (buffer[j] == BASE58ALPHABET[0])) {
+	// the last pass may have produced leading zero digits
+	while ((j < SIZEOF(buffer)) && (buffer[j] == BASE58ALPHABET[0])) {
 		++j;
 	}
 	while (zeroCount-- > 0) {
 		ASSERT((0 < j) && (j <= SIZEOF(buffer)));
 		buffer[--j] = BASE58ALPHABET[0];
 	}
-	size_t outSize = 2 * inSize - j;
+	size_t outSize = SIZEOF(buffer) - j;
 
 	ASSERT(outSize < outMaxSize);
 
@@ -17,6 +17,79 @@ void testcase_base58(const char* inputHex, const char* expectedStr)
 	EXPECT_EQ_BYTES(expectedStr, outputStr, outputLen + 1);
 }
 
+// the previous implementation dividing the input by 58 one byte at a time
+static size_t base58_encode_reference(
+        const uint8_t* inBuffer, size_t inSize,
+        char* outStr, size_t outMaxSize
+)
+{
+	/* cspell:disable-next-line */
+	static const char ALPHABET[] = "123456789ABCDEFGHJKLMNPQRSTUVWXYZabcdefghijkmnopqrstuvwxyz";
+	uint8_t tmpBuffer[124] = {0};
+	uint8_t buffer[124 * 2] = {0};
+
+	ASSERT(inSize <= SIZEOF(tmpBuffer));
+	memmove(tmpBuffer, inBuffer, inSize);
+
+	size_t zeroCount = 0;
+	while ((zeroCount < inSize) && (tmpBuffer[zeroCount] == 0)) {
+		++zeroCount;
+	}
+	size_t j = 2 * inSize;
+	size_t startAt = zeroCount;
+	while (startAt < inSize) {
+		unsigned short remainder = 0;
+		for (size_t divLoop = startAt; divLoop < inSize; divLoop++) {
+			unsigned short tmpDiv = remainder * 256 + tmpBuffer[divLoop];
+			tmpBuffer[divLoop] = (unsigned char)(tmpDiv / 58);
+			remainder = (tmpDiv % 58);
+		}
+		if (tmpBuffer[startAt] == 0) {
+			++startAt;
+		}
+		buffer[--j] = ALPHABET[remainder];
+	}
+	while ((j < (2 * inSize)) && (buffer[j] == ALPHABET[0])) {
+		++j;
+	}
+	while (zeroCount-- > 0) {
+		buffer[--j] = ALPHABET[0];
+	}
+	size_t outSize = 2 * inSize - j;
+
+	ASSERT(outSize < outMaxSize);
+	memmove(outStr, (buffer + j), outSize);
+	outStr[outSize] = 0;
+	return outSize;
+}
+
+// compares the encoder with the reference one on pseudo-random inputs of all sizes,
+// including leading zero bytes and the maximal size used by Byron addresses
+static void testcase_base58_differential()
+{
+	PRINTF("testcase_base58_differential\n");
+	uint32_t state = 0x12345678; // xorshift32
+
+	for (size_t inputSize = 0; inputSize <= 124; inputSize++) {
+		for (size_t zeros = 0; zeros <= 2 && zeros <= inputSize; zeros++) {
+			uint8_t input[124] = {0};
+			for (size_t i = zeros; i < inputSize; i++) {
+				state ^= state << 13;
+				state ^= state >> 17;
+				state ^= state << 5;
+				input[i] = (uint8_t) state;
+			}
+
+			char expected[2 * 124 + 1] = {0};
+			char output[2 * 124 + 1] = {0};
+			size_t expectedLen = base58_encode_reference(input, inputSize, expected, SIZEOF(expected));
+			size_t outputLen = base58_encode(input, inputSize, output, SIZEOF(output));
+			EXPECT_EQ(outputLen, expectedLen);
+			EXPECT_EQ_BYTES(expected, output, outputLen + 1);
+		}
+	}
+}
+
 void run_base58_test()
 {
 	struct {
@@ -53,6 +126,7 @@ void run_base58_test()
 	ITERATE(it, testVectors) {
 		testcase_base58(PTR_PIC(it->inputHex), PTR_PIC(it->expectedHex));
 	}
+	testcase_base58_differential();
 }
 
 #endif // DEVEL
@@ -35,58 +35,61 @@ uint32_t bech32_polymod_step(uint32_t pre)
 /* cspell:disable-next-line */
 static const char* charset = "qpzry9x8gf2tvdw0s3jn54khce6mua7l";
 
-/** Encode a Bech32 string
- *
- *  Out: output:  Pointer to a buffer of size >= strlen(hrp) + data_len + 8 that
- *                will be updated to contain the null-terminated Bech32 string.
- *  In: hrp :     Pointer to the null-terminated human readable part.
- *      data :    Pointer to an array of 5-bit values.
- *      data_len: Length of the data array.
- */
-void bech32_encode_5bit(const char* hrp, const uint8_t* data,
-                        size_t data_len, char* output, size_t maxOutputSize)
+#define BECH32_KNOWN_HRP_LENGTH_MAX 10
+
+// checksum states after processing the expanded human-readable part
+// (the high bits of its characters, zero, the low bits of its characters)
+// for the prefixes used most often
+static const struct {
+	char hrp[BECH32_KNOWN_HRP_LENGTH_MAX + 1];
+	uint32_t checksumState;
+} KNOWN_HRP_STATES[] = {
+	{"addr",       0x17747fcb},
+	{"addr_test",  0x0bda92c6},
+	{"stake",      0x033b38df},
+	{"stake_test", 0x0ae3842c},
+	{"asset",      0x0218f10e},
+	{"pool",       0x177cd2b5},
+};
+
+static uint32_t _computeHrpChecksumState(const char* hrp)
 {
-	ASSERT(maxOutputSize < BUFFER_SIZE_PARANOIA);
-	ASSERT(maxOutputSize >= strlen(hrp) + data_len + 8);
-	const char* outputLimit = output + maxOutputSize;
-
-#define APPEND_OUT(value) {ASSERT(output < outputLimit); *(output++) = (value);}
-
 	uint32_t chk = 1;
-	{
-		size_t i = 0;
-		while (hrp[i] != 0) {
-			ASSERT(!(hrp[i] >= 'A' && hrp[i] <= 'Z'));
-			ASSERT((hrp[i] >> 5) != 0);
-			chk = bech32_polymod_step(chk) ^ (hrp[i] >> 5);
-			++i;
-		}
+	for (size_t i = 0; hrp[i] != 0; i++) {
+		ASSERT(!(hrp[i] >= 'A' && hrp[i] <= 'Z'));
+		ASSERT((hrp[i] >> 5) != 0);
+		chk = bech32_polymod_step(chk) ^ (hrp[i] >> 5);
 	}
 	chk = bech32_polymod_step(chk);
-	while (*hrp != 0) {
-		chk = bech32_polymod_step(chk) ^ (*hrp & 0x1f);
-		APPEND_OUT(*(hrp++));
+	for (size_t i = 0; hrp[i] != 0; i++) {
+		chk = bech32_polymod_step(chk) ^ (hrp[i] & 0x1f);
 	}
+	return chk;
+}
 
-	APPEND_OUT('1');
-
-	for (size_t i = 0; i < data_len; ++i) {
-		ASSERT((*data >> 5) == 0);
-		chk = bech32_polymod_step(chk) ^ (*data);
-		APPEND_OUT(charset[*(data++)]);
-	}
-	for (size_t i = 0; i < 6; ++i) {
-		chk = bech32_polymod_step(chk);
+static uint32_t _getHrpChecksumState(const char* hrp)
+{
+	ITERATE(it, KNOWN_HRP_STATES) {
+		if (strcmp(it->hrp, hrp) == 0) {
+			return it->checksumState;
+		}
 	}
-	chk ^= 1;
-	for (size_t i = 0; i < 6; ++i) {
-		APPEND_OUT(charset[(chk >> ((5 - i) * 5)) & 0x1f]);
+	return _computeHrpChecksumState(hrp);
+}
+
+#ifdef DEVEL
+bool bech32_areKnownHrpStatesValid()
+{
+	ITERATE(it, KNOWN_HRP_STATES) {
+		if (_computeHrpChecksumState(it->hrp) != it->checksumState) {
+			return false;
+		}
 	}
-	APPEND_OUT(0);
+	return true;
 }
+#endif // DEVEL
 
 // we are not supposed to use more for Cardano Shelley
-// WARNING: increasing this would take more stack space, see data5bit definition below
 #define MAX_BYTES 65
 
 size_t bech32_encode(const char* hrp, const uint8_t* bytes, size_t bytesSize,
@@ -103,33 +106,49 @@ size_t bech32_encode(const char* hrp, const uint8_t* bytes, size_t bytesSize,
 	ASSERT(maxOutputSize < BUFFER_SIZE_PARANOIA);
 	ASSERT(bytesSize < BUFFER_SIZE_PARANOIA);
 
-	uint8_t data5bit[(8 * MAX_BYTES + 4) / 5] = {0}; // ceiling of (8/5 * MAX_BYTES_LEN) = 104
-	size_t data5bitLength = 0;
-	{
-		const int OUTBITS = 5;
-		const int INBITS = 8;
-
-		// originally convert_bits()
-		uint32_t val = 0;
-		int bits = 0;
-		uint32_t maxv = (((uint32_t)1) << OUTBITS) - 1;
-		while (bytesSize--) {
-			val = (val << INBITS) | *(bytes++);
-			bits += INBITS;
-			while (bits >= OUTBITS) {
-				bits -= OUTBITS;
-				ASSERT(data5bitLength < SIZEOF(data5bit));
-				data5bit[data5bitLength++] = (val >> bits) & maxv;
-			}
+	const char* outputStart = output;
+	const char* outputLimit = output + maxOutputSize;
+
+#define APPEND_OUT(value) {ASSERT(output < outputLimit); *(output++) = (value);}
+
+	uint32_t chk = _getHrpChecksumState(hrp);
+	while (*hrp != 0) {
+		APPEND_OUT(*(hrp++));
+	}
+
+	APPEND_OUT('1');
+
+	// every 5 bytes (40 bits) give 8 characters,
+	// the last block is padded with zero bits to a multiple of 5 bits
+	while (bytesSize > 0) {
+		const size_t blockSize = MIN(bytesSize, 5);
+		uint64_t block = 0;
+		for (size_t i = 0; i < 5; i++) {
+			block = (block << 8) | ((i < blockSize) ? bytes[i] : 0);
 		}
-		if (bits) {
-			ASSERT(data5bitLength < SIZEOF(data5bit));
-			data5bit[data5bitLength++] = (val << (OUTBITS - bits)) & maxv;
+		bytes += blockSize;
+		bytesSize -= blockSize;
+
+		const size_t numChars = (8 * blockSize + 4) / 5;
+		for (size_t i = 0; i < numChars; i++) {
+			const uint8_t value = (uint8_t) (block >> (35 - 5 * i)) & 0x1f;
+			chk = bech32_polymod_step(chk) ^ value;
+			APPEND_OUT(charset[value]);
 		}
 	}
 
-	bech32_encode_5bit(hrp, data5bit, data5bitLength, output, maxOutputSize);
-	ASSERT(strlen(output) == supposedOutputLength);
+	for (size_t i = 0; i < 6; ++i) {
+		chk = bech32_polymod_step(chk);
+	}
+	chk ^= 1;
+	for (size_t i = 0; i < 6; ++i) {
+		APPEND_OUT(charset[(chk >> ((5 - i) * 5)) & 0x1f]);
+	}
+	APPEND_OUT(0);
+
+#undef APPEND_OUT
+
+	ASSERT(strlen(outputStart) == supposedOutputLength);
 
 	return supposedOutputLength;
 }
@@ -3,6 +3,7 @@
 
 #include <stdint.h>
 #include <stddef.h>
+#include <stdbool.h>
 
 /*
  * Encode bytes, using human-readable prefix given in hrp.
@@ -17,6 +18,9 @@ size_t bech32_encode(const char* hrp, const uint8_t* bytes, size_t bytesSize, ch
 
 
 #ifdef DEVEL
+// the encoder relies on precomputed checksum states of common prefixes
+bool bech32_areKnownHrpStatesValid();
+
 void run_bech32_test();
 #endif // DEVEL
 
@@ -42,12 +42,26 @@ void run_bech32_test()
 		{"abcdef", "00443214c74254b635cf84653a56d7c675be77df", "abcdef1qpzry9x8gf2tvdw0s3jn54khce6mua7lmqqqxw"},
 		{"1", "000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000", "11qqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqc8247j"},
 		{"split", "c5f38b70305f519bf66d85fb6cf03058f3dde463ecd7918f2dc743918f2d", "split1checkupstagehandshakeupstreamerranterredcaperred2y9e3w"},
-		{"addr", "009493315cd92eb5d8c4304e67b7e16ae36d61d34502694657811a2c8e32c728d3861e164cab28cb8f006448139c8f1740ffb8e7aa9e5232dc", "addr1qz2fxv2umyhttkxyxp8x0dlpdt3k6cwng5pxj3jhsydzer3jcu5d8ps7zex2k2xt3uqxgjqnnj83ws8lhrn648jjxtwqcyl47r"}
+		{"addr", "009493315cd92eb5d8c4304e67b7e16ae36d61d34502694657811a2c8e32c728d3861e164cab28cb8f006448139c8f1740ffb8e7aa9e5232dc", "addr1qz2fxv2umyhttkxyxp8x0dlpdt3k6cwng5pxj3jhsydzer3jcu5d8ps7zex2k2xt3uqxgjqnnj83ws8lhrn648jjxtwqcyl47r"},
+		// prefixes with precomputed checksum states, payloads not divisible into 5-byte blocks
+		{"addr_test", "c07adb207093de3b64901545a3fd9f7dd917108f019f0f359c7223d08c3517d2c07adb207093de3b64901545a3fd9f7dd917108f019f0f359c", "addr_test1cpadkgrsj00rkeysz4z68lvl0hv3wyy0qx0s7dvuwg3aprp4zlfvq7kmypcf8h3mvjgp23drlk0hmkghzz8sr8c0xkwqurvmap"},
+		{"stake", "79907e4978d92131ec544f64d262a034980b461bbbd4ea9e1e4880e527", "stake10xg8ujtcmysnrmz5fajdyc4qxjvqk3smh02w48s7fzqw2fce343na"},
+		{"stake_test", "e2640c1270b612514113424a8eb5601def6f84f2f01895d6fed1378f3c", "stake_test1ufjqcynskcf9zsgngf9gadtqrhhklp8j7qvft4h76ymc70qgzx4ak"},
+		{"asset", "06c485332cf57964effbbf9b566ad3c0793fe005", "asset1qmzg2vev74ukfmlmh7d4v6kncpunlcq9gqr8pp"},
+		{"pool", "a4ae57776be7b8ff006f9bb51bb4277d5e660dd6bef9495bff4b93a0", "pool15jh9wamtu7u07qr0nw63hdp8040xvrwkhmu5jkllfwf6ql0h9u7"},
+		{"pool", "2f", "pool19uydzync"},
+		{"asset", "7559", "asset1w4vs485uf2"},
+		{"stake", "8bb62e", "stake13wmzucj3zj8"},
+		{"addr", "0526912b", "addr1q5nfz2cf467se"},
+		{"addr", "bcd250065cf25edf8717262f8da3c2734dbedf38917709c14b26e47ab8893e7fbcd250065cf25edf8717262f8da3c2734dbedf38917709c14b26e47ab8893e7fbc", "addr1hnf9qpju7f0dlpchychcmg7zwdxmahecj9msns2tymj84wyf8elme5jsqew0yhklsutjvtud50p8xnd7muufzacfc99jder6hzynulauve6ljg"}
 		/* cspell:enable */
 	};
 	ITERATE(it, testVectors) {
 		testcase_bech32(PTR_PIC(it->hrp), PTR_PIC(it->inputBytesHex), PTR_PIC(it->expectedHex));
 	}
+
+	PRINTF("test_knownHrpStates\n");
+	EXPECT_EQ(bech32_areKnownHrpStatesValid(), true);
 }
 
 #endif // DEVEL
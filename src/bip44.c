@@ -3,6 +3,7 @@
 #include "endian.h"
 #include "hash.h"
 #include "keyDerivation.h"
+#include "derivationCache.h"
 
 static const uint32_t CARDANO_CHAIN_EXTERNAL = 0;
 static const uint32_t CARDANO_CHAIN_INTERNAL = 1;
@@ -279,6 +280,21 @@ bool bip44_isCVoteKeyPath(const bip44_path_t* pathSpec)
 #undef CHECK
 }
 
+// m/purpose'/coin_type'/account'/chain/address
+// where the last two levels can be derived from the account node without the seed
+bool bip44_isDerivableFromAccount(const bip44_path_t* pathSpec)
+{
+#define CHECK(cond) if (!(cond)) return false
+	CHECK(pathSpec->length == BIP44_I_ADDRESS + 1);
+	CHECK(isHardened(pathSpec->path[BIP44_I_PURPOSE]));
+	CHECK(isHardened(pathSpec->path[BIP44_I_COIN_TYPE]));
+	CHECK(isHardened(pathSpec->path[BIP44_I_ACCOUNT]));
+	CHECK(!isHardened(pathSpec->path[BIP44_I_CHAIN]));
+	CHECK(!isHardened(pathSpec->path[BIP44_I_ADDRESS]));
+	return true;
+#undef CHECK
+}
+
 // returns the length of the resulting string
 size_t bip44_printToStr(const bip44_path_t* pathSpec, char* out, size_t outSize)
 {
@@ -511,17 +527,12 @@ void bip44_pathToKeyHash(const bip44_path_t* pathSpec, uint8_t* hash, size_t has
 {
 	ASSERT(hashSize < BUFFER_SIZE_PARANOIA);
 
-	extendedPublicKey_t extPubKey;
-	deriveExtendedPublicKey(pathSpec, &extPubKey);
-
 	switch (hashSize) {
 	case 28:
 		ASSERT(hashSize * 8 == 224);
 
-		blake2b_224_hash(
-		        extPubKey.pubKey, SIZEOF(extPubKey.pubKey),
-		        hash, hashSize
-		);
+		// the same keys are often needed repeatedly within an instruction
+		derivationCache_getKeyHash(pathSpec, hash, hashSize);
 		return;
 
 	default:
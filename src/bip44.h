@@ -84,6 +84,8 @@ bool bip44_isPoolColdKeyPath(const bip44_path_t* pathSpec);
 
 bool bip44_isCVoteKeyPath(const bip44_path_t* pathSpec);
 
+bool bip44_isDerivableFromAccount(const bip44_path_t* pathSpec);
+
 size_t bip44_printToStr(const bip44_path_t*, char* out, size_t outSize);
 
 
@@ -78,6 +78,18 @@ __DEFINE_VIEW_skip(write_view, ERR_DATA_TOO_LARGE)
 #define view_check(view)            __VIEW_GENERIC_TEMPLATE(view, check)(view)
 
 
+// a view over the response part of G_io_apdu_buffer, see io_send_responseBuffer
+static inline write_view_t make_response_view()
+{
+	return make_write_view(io_responseBufferBegin(), io_responseBufferEnd());
+}
+
+static inline void view_sendResponse(uint16_t code, const write_view_t* view)
+{
+	write_view_check(view);
+	io_send_responseBuffer(code, view->ptr);
+}
+
 static inline void view_appendToken(write_view_t* view, uint8_t type, uint64_t value)
 {
 	ASSERT(view_remainingSize(view) <= BUFFER_SIZE_PARANOIA);
@@ -112,6 +124,50 @@ static inline void view_parseBuffer(uint8_t* destBuffer, read_view_t* view, size
 	view_skipBytes(view, length);
 }
 
+// Returns the next `length` bytes of the view without copying them.
+// The result is only borrowed, i.e. valid as long as the underlying buffer is
+// (for wire data, until the response is sent).
+static inline const uint8_t* view_borrowBuffer(read_view_t* view, size_t length)
+{
+	ASSERT(length < BUFFER_SIZE_PARANOIA);
+
+	VALIDATE(view_remainingSize(view) >= length, ERR_INVALID_DATA);
+	const uint8_t* borrowed = view->ptr;
+	view_skipBytes(view, length);
+	return borrowed;
+}
+
+/*
+ * Fixed-layout records
+ *
+ * A record type is a struct of bytes and byte arrays describing a fixed part of the wire data, e.g.
+ *     typedef struct { uint8_t amount[8]; uint8_t index[4]; } wire_foo_t;
+ * The size of the whole record is validated once and its fields are then read
+ * by u<width>be_read without any further checks. Since all members have alignment 1,
+ * there is no padding, so the size and the offsets both follow from the declaration.
+ * The record is borrowed from the view (see view_borrowBuffer).
+ */
+
+// does not compile for records with wider members (padding, unaligned access)
+#define __VIEW_RECORD_SIZE(recordType) \
+	(sizeof(recordType) + 0 * sizeof(char[(__alignof__(recordType) == 1) ? 1 : -1]))
+
+// throws ERR_INVALID_DATA if not enough data
+#define view_parseRecord(view, recordType) \
+	((const recordType*) view_borrowBuffer(view, __VIEW_RECORD_SIZE(recordType)))
+
+// <count> consecutive records, throws ERR_INVALID_DATA if not enough data
+#define view_parseRecords(view, recordType, count) \
+	((const recordType*) view_borrowRecords(view, __VIEW_RECORD_SIZE(recordType), count))
+
+static inline const uint8_t* view_borrowRecords(read_view_t* view, size_t recordSize, size_t count)
+{
+	ASSERT(recordSize < BUFFER_SIZE_PARANOIA);
+	ASSERT(count < BUFFER_SIZE_PARANOIA);
+
+	return view_borrowBuffer(view, recordSize * count);
+}
+
 // Note(ppershing): these macros expand to two arguments!
 #define VIEW_REMAINING_TO_TUPLE_BUF_SIZE(view) (view)->ptr, view_remainingSize(view)
 #define VIEW_PROCESSED_TO_TUPLE_BUF_SIZE(view) (view)->begin, view_processedSize(view)
@@ -143,4 +199,8 @@ static inline int64_t parse_int64be(read_view_t* view)
 };
 
 
+#ifdef DEVEL
+void run_bufView_test();
+#endif // DEVEL
+
 #endif // H_CARDANO_APP_BUF_VIEW
@@ -0,0 +1,73 @@
+#ifdef DEVEL
+
+#include "bufView.h"
+#include "testUtils.h"
+
+typedef struct {
+	uint8_t type;
+	uint8_t amount[8];
+	uint8_t index[4];
+} test_record_t;
+
+typedef struct {
+	uint8_t value[2];
+} test_item_t;
+
+static void testParseRecord()
+{
+	PRINTF("testcase_parseRecord\n");
+
+	const uint8_t buffer[] = {
+		0x03,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x0F, 0x42, 0x40,
+		0x47, 0x11, 0x22, 0x33,
+		0x99 // trailing data
+	};
+	STATIC_ASSERT(sizeof(test_record_t) == 13, "bad record size");
+
+	read_view_t view = make_read_view(buffer, buffer + SIZEOF(buffer));
+	const test_record_t* record = view_parseRecord(&view, test_record_t);
+
+	EXPECT_EQ(record->type, 0x03);
+	EXPECT_EQ(u8be_read(record->amount), 1000000);
+	EXPECT_EQ(u4be_read(record->index), 0x47112233);
+	EXPECT_EQ(view_remainingSize(&view), 1);
+
+	// not enough data left
+	EXPECT_THROWS(view_parseRecord(&view, test_record_t), ERR_INVALID_DATA);
+	EXPECT_EQ(view_remainingSize(&view), 1);
+
+	// the whole record is validated, not only its first field
+	view = make_read_view(buffer, buffer + SIZEOF(buffer) - 2);
+	EXPECT_THROWS(view_parseRecord(&view, test_record_t), ERR_INVALID_DATA);
+}
+
+static void testParseRecords()
+{
+	PRINTF("testcase_parseRecords\n");
+
+	const uint8_t buffer[] = {0x00, 0x01, 0x47, 0x11, 0xFF, 0xFF, 0x12};
+
+	read_view_t view = make_read_view(buffer, buffer + SIZEOF(buffer));
+	const test_item_t* items = view_parseRecords(&view, test_item_t, 3);
+
+	EXPECT_EQ(u2be_read(items[0].value), 0x0001);
+	EXPECT_EQ(u2be_read(items[1].value), 0x4711);
+	EXPECT_EQ(u2be_read(items[2].value), 0xFFFF);
+	EXPECT_EQ(view_remainingSize(&view), 1);
+
+	// no records
+	view_parseRecords(&view, test_item_t, 0);
+	EXPECT_EQ(view_remainingSize(&view), 1);
+
+	view = make_read_view(buffer, buffer + SIZEOF(buffer));
+	EXPECT_THROWS(view_parseRecords(&view, test_item_t, 4), ERR_INVALID_DATA);
+}
+
+void run_bufView_test()
+{
+	testParseRecord();
+	testParseRecords();
+}
+
+#endif // DEVEL
@@ -42,6 +42,16 @@ enum {
 	CBOR_TAG_EMBEDDED_CBOR_BYTE_STRING = 24,
 };
 
+// Tokens with values known at build time, usable in constant initializers.
+// The bytes are the same as those written by cbor_writeToken;
+// a value out of range for the chosen width does not compile.
+#define CBOR_TOKEN_SMALL(type, value) \
+	((uint8_t) ((type) + (value) + 0 * sizeof(char[((value) < 24) ? 1 : -1])))
+
+#define CBOR_TOKEN_U8(type, value) \
+	((uint8_t) ((type) + 24)), \
+	((uint8_t) ((value) + 0 * sizeof(char[((value) >= 24 && (value) <= 0xFF) ? 1 : -1])))
+
 typedef struct {
 	uint8_t type;
 	uint8_t width; // Contains number of *additional* bytes carrying the value
@@ -0,0 +1,504 @@
+#include "state.h"
+#include "securityPolicy.h"
+#include "uiHelpers.h"
+#include "checkOwnership.h"
+#include "addressUtilsShelley.h"
+#include "addressUtilsByron.h"
+#include "derivationCache.h"
+#include "softDerivation.h"
+#include "hash.h"
+#include "bufView.h"
+#include "endian.h"
+#include "backgroundTasks.h"
+
+static ins_check_ownership_context_t* ctx = &(instructionState.checkOwnershipContext);
+
+// this is supposed to be called at the beginning of each APDU handler
+static inline void CHECK_STAGE(check_ownership_stage_t expected)
+{
+	TRACE("Checking stage... current one is %d, expected %d", ctx->stage, expected);
+	VALIDATE(ctx->stage == expected, ERR_INVALID_STATE);
+}
+
+static void advanceStage()
+{
+	TRACE("Advancing from stage: %d", ctx->stage);
+
+	switch (ctx->stage) {
+
+	case CHECK_OWNERSHIP_STAGE_INIT:
+		ctx->stage = CHECK_OWNERSHIP_STAGE_CHECK;
+		break;
+
+	case CHECK_OWNERSHIP_STAGE_CHECK:
+		ASSERT(ctx->currentAddress == ctx->numAddresses);
+		ctx->stage = CHECK_OWNERSHIP_STAGE_NONE;
+		ui_idle(); // we are done with this check
+		break;
+
+	case CHECK_OWNERSHIP_STAGE_NONE:
+	default:
+		ASSERT(false);
+	}
+}
+
+// ============================== CANDIDATES ==============================
+
+static size_t _numCandidates()
+{
+	return (size_t) ctx->numAccounts * CHECK_OWNERSHIP_NUM_CHAINS * ctx->numAddressesPerChain;
+}
+
+static bool _isByron()
+{
+	return ctx->purpose == harden(PURPOSE_BYRON);
+}
+
+// candidates are ordered by account, chain and address
+static void _getCandidatePath(size_t candidate, bip44_path_t* pathSpec)
+{
+	ASSERT(candidate < _numCandidates());
+
+	const size_t numAddressesPerAccount = CHECK_OWNERSHIP_NUM_CHAINS * ctx->numAddressesPerChain;
+
+	explicit_bzero(pathSpec, SIZEOF(*pathSpec));
+	pathSpec->path[BIP44_I_PURPOSE] = ctx->purpose;
+	pathSpec->path[BIP44_I_COIN_TYPE] = harden(ADA_COIN_TYPE);
+	pathSpec->path[BIP44_I_ACCOUNT] = ctx->firstAccount + (uint32_t) (candidate / numAddressesPerAccount);
+	pathSpec->path[BIP44_I_CHAIN] = (uint32_t) ((candidate / ctx->numAddressesPerChain) % CHECK_OWNERSHIP_NUM_CHAINS);
+	pathSpec->path[BIP44_I_ADDRESS] = ctx->firstAddress + (uint32_t) (candidate % ctx->numAddressesPerChain);
+	pathSpec->length = BIP44_I_ADDRESS + 1;
+}
+
+// the checksum at the end of the address
+static void _getByronAddressTag(const uint8_t* addressBuffer, size_t addressSize, uint8_t* tag)
+{
+	ASSERT(addressSize >= CHECK_OWNERSHIP_TAG_SIZE);
+	memmove(tag, addressBuffer + addressSize - CHECK_OWNERSHIP_TAG_SIZE, CHECK_OWNERSHIP_TAG_SIZE);
+}
+
+__noinline_due_to_stack__
+static void _deriveByronCandidateTag(size_t candidate, uint8_t* tag)
+{
+	bip44_path_t pathSpec;
+	_getCandidatePath(candidate, &pathSpec);
+
+	uint8_t addressBuffer[MAX_ADDRESS_SIZE] = {0};
+	const size_t addressSize = deriveAddress_byron(
+	                                   &pathSpec, ctx->protocolMagic,
+	                                   addressBuffer, SIZEOF(addressBuffer)
+	                           );
+	_getByronAddressTag(addressBuffer, addressSize, tag);
+}
+
+// the account key is derived (or taken from a cache) only once per account,
+// the chain key only once per chain, the address keys are derived publicly from it
+__noinline_due_to_stack__
+static void _deriveShelleyCandidateTag(size_t candidate, uint8_t* tag)
+{
+	bip44_path_t pathSpec;
+	_getCandidatePath(candidate, &pathSpec);
+
+	const size_t chainKeyCandidate = candidate - candidate % ctx->numAddressesPerChain;
+	if (!ctx->isChainKeyValid || ctx->chainKeyCandidate != chainKeyCandidate) {
+		bip44_path_t accountPath = pathSpec;
+		accountPath.length = BIP44_I_CHAIN;
+
+		extendedPublicKey_t accountKey;
+		derivationCache_getExtendedPublicKey(&accountPath, &accountKey);
+
+		extendedPublicKey_t chainKey;
+		softDerivation_deriveChildPublicKey(&accountKey, pathSpec.path[BIP44_I_CHAIN], &chainKey);
+
+		ctx->chainKey = chainKey;
+		ctx->chainKeyCandidate = (uint16_t) chainKeyCandidate;
+		ctx->isChainKeyValid = true;
+	}
+	const extendedPublicKey_t chainKey = ctx->chainKey;
+
+	extendedPublicKey_t addressKey;
+	softDerivation_deriveChildPublicKey(&chainKey, pathSpec.path[BIP44_I_ADDRESS], &addressKey);
+
+	uint8_t keyHash[ADDRESS_KEY_HASH_LENGTH] = {0};
+	blake2b_224_hash(
+	        addressKey.pubKey, SIZEOF(addressKey.pubKey),
+	        keyHash, SIZEOF(keyHash)
+	);
+	memmove(tag, keyHash, CHECK_OWNERSHIP_TAG_SIZE);
+}
+
+static bool _areCandidateTagsReady()
+{
+	ASSERT(ctx->numCandidateTags <= _numCandidates());
+	return ctx->numCandidateTags == _numCandidates();
+}
+
+// returns true iff there are more tags to derive
+// (it is a background task, see backgroundTasks.h)
+static bool _deriveNextCandidateTag()
+{
+	if (_areCandidateTagsReady()) return false;
+
+	const size_t candidate = ctx->numCandidateTags;
+	ASSERT(candidate < CHECK_OWNERSHIP_MAX_CANDIDATES);
+
+	uint8_t tag[CHECK_OWNERSHIP_TAG_SIZE] = {0};
+	if (_isByron()) {
+		_deriveByronCandidateTag(candidate, tag);
+	} else {
+		_deriveShelleyCandidateTag(candidate, tag);
+	}
+
+	ASSERT(ctx->numCandidateTags == candidate);
+	memmove(ctx->candidateTags[candidate], tag, CHECK_OWNERSHIP_TAG_SIZE);
+	ctx->numCandidateTags++;
+
+	return !_areCandidateTagsReady();
+}
+
+static void _deriveCandidateTags()
+{
+	ASSERT(_numCandidates() <= CHECK_OWNERSHIP_MAX_CANDIDATES);
+
+	while (_deriveNextCandidateTag()) {
+		// nothing to do
+	}
+	ASSERT(_areCandidateTagsReady());
+}
+
+static bool _hasPaymentKeyHash(uint8_t addressHeader)
+{
+	switch (getAddressType(addressHeader)) {
+	case BASE_PAYMENT_KEY_STAKE_KEY:
+	case BASE_PAYMENT_KEY_STAKE_SCRIPT:
+	case POINTER_KEY:
+	case ENTERPRISE_KEY:
+		return true;
+
+	default:
+		return false;
+	}
+}
+
+// the tags are short, so a candidate with a matching tag must be checked in full
+__noinline_due_to_stack__
+static bool _isCandidateAddress(size_t candidate, const uint8_t* addressBuffer, size_t addressSize)
+{
+	bip44_path_t pathSpec;
+	_getCandidatePath(candidate, &pathSpec);
+
+	if (_isByron()) {
+		uint8_t derivedBuffer[MAX_ADDRESS_SIZE] = {0};
+		const size_t derivedSize = deriveAddress_byron(
+		                                   &pathSpec, ctx->protocolMagic,
+		                                   derivedBuffer, SIZEOF(derivedBuffer)
+		                           );
+		return (derivedSize == addressSize) && (memcmp(derivedBuffer, addressBuffer, addressSize) == 0);
+	}
+
+	ASSERT(addressSize >= 1 + ADDRESS_KEY_HASH_LENGTH);
+	uint8_t keyHash[ADDRESS_KEY_HASH_LENGTH] = {0};
+	derivationCache_getKeyHash(&pathSpec, keyHash, SIZEOF(keyHash));
+	return memcmp(keyHash, addressBuffer + 1, SIZEOF(keyHash)) == 0;
+}
+
+// only the payment part of Shelley addresses is considered
+static bool _findOwner(const uint8_t* addressBuffer, size_t addressSize, size_t* candidate)
+{
+	ASSERT(_areCandidateTagsReady());
+
+	uint8_t tag[CHECK_OWNERSHIP_TAG_SIZE] = {0};
+	const uint8_t header = getAddressHeader(addressBuffer, addressSize);
+
+	if (_isByron()) {
+		if (getAddressType(header) != BYRON) return false;
+		if (addressSize < CHECK_OWNERSHIP_TAG_SIZE) return false;
+		_getByronAddressTag(addressBuffer, addressSize, tag);
+	} else {
+		if (!_hasPaymentKeyHash(header)) return false;
+		if (addressSize < 1 + ADDRESS_KEY_HASH_LENGTH) return false;
+		memmove(tag, addressBuffer + 1, CHECK_OWNERSHIP_TAG_SIZE);
+	}
+
+	for (size_t i = 0; i < _numCandidates(); i++) {
+		if (memcmp(ctx->candidateTags[i], tag, CHECK_OWNERSHIP_TAG_SIZE) != 0) continue;
+
+		if (_isCandidateAddress(i, addressBuffer, addressSize)) {
+			*candidate = i;
+			return true;
+		}
+	}
+	return false;
+}
+
+// ============================== INIT ==============================
+
+enum {
+	HANDLE_INIT_UI_STEP_WARNING = 100,
+	HANDLE_INIT_UI_STEP_DISPLAY,
+	HANDLE_INIT_UI_STEP_CONFIRM,
+	HANDLE_INIT_UI_STEP_RESPOND,
+	HANDLE_INIT_UI_STEP_INVALID,
+};
+
+static void checkOwnership_handleInit_ui_runStep()
+{
+	TRACE("UI step %d", ctx->ui_step);
+	ui_callback_fn_t* this_fn = checkOwnership_handleInit_ui_runStep;
+
+	UI_STEP_BEGIN(ctx->ui_step, this_fn);
+	UI_STEP(HANDLE_INIT_UI_STEP_WARNING) {
+		ui_displayPaginatedText(
+		        "Unusual request",
+		        "Proceed with care",
+		        this_fn
+		);
+	}
+	UI_STEP(HANDLE_INIT_UI_STEP_DISPLAY) {
+		char body[100] = {0};
+		explicit_bzero(body, SIZEOF(body));
+		STATIC_ASSERT(sizeof(ctx->numAddresses) <= sizeof(unsigned), "oversized type for %u");
+		STATIC_ASSERT(!IS_SIGNED(ctx->numAddresses), "signed type for %u");
+		const uint32_t firstAccount = unharden(ctx->firstAccount);
+		snprintf(
+		        body, SIZEOF(body),
+		        "%u addresses in %s accounts #%u to #%u",
+		        ctx->numAddresses,
+		        _isByron() ? "Byron" : "Shelley",
+		        (unsigned) (firstAccount + 1),
+		        (unsigned) (firstAccount + ctx->numAccounts)
+		);
+		// make sure all the information is displayed to the user
+		ASSERT(strlen(body) + 1 < SIZEOF(body));
+
+		ui_displayPaginatedText("Check ownership of", body, this_fn);
+	}
+	UI_STEP(HANDLE_INIT_UI_STEP_CONFIRM) {
+		ui_displayPrompt(
+		        "Confirm",
+		        "ownership check?",
+		        this_fn,
+		        respond_with_user_reject
+		);
+	}
+	UI_STEP(HANDLE_INIT_UI_STEP_RESPOND) {
+		// the rest of the tags not derived in the background
+		_deriveCandidateTags();
+
+		io_send_buf(SUCCESS, NULL, 0);
+		ui_displayBusy(); // displays dots, called only after I/O to avoid freezing
+
+		advanceStage();
+	}
+	UI_STEP_END(HANDLE_INIT_UI_STEP_INVALID);
+}
+
+__noinline_due_to_stack__
+static void checkOwnership_handleInitAPDU(uint8_t p2, const uint8_t* wireDataBuffer, size_t wireDataSize)
+{
+	{
+		CHECK_STAGE(CHECK_OWNERSHIP_STAGE_INIT);
+		VALIDATE(p2 == P2_UNUSED, ERR_INVALID_REQUEST_PARAMETERS);
+
+		ASSERT(wireDataSize < BUFFER_SIZE_PARANOIA);
+	}
+	{
+		// parse data
+		TRACE_BUFFER(wireDataBuffer, wireDataSize);
+		read_view_t view = make_read_view(wireDataBuffer, wireDataBuffer + wireDataSize);
+
+		typedef struct {
+			uint8_t purpose[4];
+			uint8_t firstAccount[4];
+			uint8_t numAccounts;
+			uint8_t firstAddress[4];
+			uint8_t numAddressesPerChain[4];
+			uint8_t protocolMagic[4];
+			uint8_t numAddresses[4];
+		} wire_search_window_t;
+
+		const wire_search_window_t* wireWindow = view_parseRecord(&view, wire_search_window_t);
+		VALIDATE(view_remainingSize(&view) == 0, ERR_INVALID_DATA);
+
+		ctx->purpose = u4be_read(wireWindow->purpose);
+		ctx->firstAccount = u4be_read(wireWindow->firstAccount);
+		const uint8_t numAccounts = wireWindow->numAccounts;
+		ctx->firstAddress = u4be_read(wireWindow->firstAddress);
+		const uint32_t numAddressesPerChain = u4be_read(wireWindow->numAddressesPerChain);
+		ctx->protocolMagic = u4be_read(wireWindow->protocolMagic);
+		const uint32_t numAddresses = u4be_read(wireWindow->numAddresses);
+
+		TRACE(
+		        "Purpose %u, accounts %u + %u, addresses %u + %u, %u addresses to check",
+		        (unsigned) ctx->purpose, (unsigned) ctx->firstAccount, (unsigned) numAccounts,
+		        (unsigned) ctx->firstAddress, (unsigned) numAddressesPerChain, (unsigned) numAddresses
+		);
+
+		VALIDATE(
+		        ctx->purpose == harden(PURPOSE_SHELLEY) || ctx->purpose == harden(PURPOSE_BYRON),
+		        ERR_INVALID_DATA
+		);
+
+		VALIDATE(isHardened(ctx->firstAccount), ERR_INVALID_DATA);
+		VALIDATE(numAccounts > 0, ERR_INVALID_DATA);
+		// the last account must not overflow
+		VALIDATE(ctx->firstAccount <= UINT32_MAX - (numAccounts - 1u), ERR_INVALID_DATA);
+		ctx->numAccounts = numAccounts;
+
+		VALIDATE(!isHardened(ctx->firstAddress), ERR_INVALID_DATA);
+		VALIDATE(numAddressesPerChain > 0, ERR_INVALID_DATA);
+		VALIDATE(numAddressesPerChain <= CHECK_OWNERSHIP_MAX_CANDIDATES, ERR_INVALID_DATA);
+		// the last address must not be hardened
+		VALIDATE(numAddressesPerChain - 1 < HARDENED_BIP32 - ctx->firstAddress, ERR_INVALID_DATA);
+		ctx->numAddressesPerChain = (uint16_t) numAddressesPerChain;
+
+		VALIDATE(_numCandidates() <= CHECK_OWNERSHIP_MAX_CANDIDATES, ERR_INVALID_DATA);
+
+		VALIDATE(numAddresses > 0, ERR_INVALID_DATA);
+		VALIDATE(numAddresses <= CHECK_OWNERSHIP_MAX_ADDRESSES, ERR_INVALID_DATA);
+		ASSERT_TYPE(ctx->numAddresses, uint16_t);
+		STATIC_ASSERT(CHECK_OWNERSHIP_MAX_ADDRESSES <= UINT16_MAX, "wrong max number of addresses");
+		ctx->numAddresses = (uint16_t) numAddresses;
+		ctx->currentAddress = 0;
+	}
+
+	security_policy_t policy = POLICY_DENY;
+	{
+		bip44_path_t lastAddressPath;
+		_getCandidatePath(_numCandidates() - 1, &lastAddressPath);
+		bip44_path_t lastAccountPath = lastAddressPath;
+		lastAccountPath.length = BIP44_I_CHAIN;
+
+		policy = policyForCheckOwnershipInit(&lastAccountPath, &lastAddressPath);
+		TRACE("Policy: %d", (int) policy);
+		ENSURE_NOT_DENIED(policy);
+	}
+	{
+		// select UI steps
+		switch (policy) {
+#define  CASE(POLICY, UI_STEP) case POLICY: {ctx->ui_step=UI_STEP; break;}
+			CASE(POLICY_PROMPT_WARN_UNUSUAL,    HANDLE_INIT_UI_STEP_WARNING);
+			CASE(POLICY_PROMPT_BEFORE_RESPONSE, HANDLE_INIT_UI_STEP_DISPLAY);
+			CASE(POLICY_ALLOW_WITHOUT_PROMPT,   HANDLE_INIT_UI_STEP_RESPOND);
+#undef   CASE
+		default:
+			THROW(ERR_NOT_IMPLEMENTED);
+		}
+	}
+
+	// nothing is returned before the user confirms the request
+	// but the tags can be derived while the user is reviewing it
+	backgroundTasks_schedule(_deriveNextCandidateTag);
+
+	checkOwnership_handleInit_ui_runStep();
+}
+
+// ============================== CHECK ==============================
+
+// the bitmap of owned addresses is a single byte
+STATIC_ASSERT(CHECK_OWNERSHIP_MAX_ADDRESSES_PER_APDU <= 8, "too many addresses per APDU");
+
+__noinline_due_to_stack__
+static void checkOwnership_handleCheckAPDU(uint8_t p2, const uint8_t* wireDataBuffer, size_t wireDataSize)
+{
+	{
+		CHECK_STAGE(CHECK_OWNERSHIP_STAGE_CHECK);
+		VALIDATE(p2 == P2_UNUSED, ERR_INVALID_REQUEST_PARAMETERS);
+
+		ASSERT(wireDataSize < BUFFER_SIZE_PARANOIA);
+		ASSERT(ctx->currentAddress < ctx->numAddresses);
+	}
+
+	uint8_t ownedBitmap = 0;
+	size_t owners[CHECK_OWNERSHIP_MAX_ADDRESSES_PER_APDU] = {0};
+	size_t numOwned = 0;
+	uint8_t numAddresses = 0;
+	{
+		// parse data and look for the owners
+		TRACE_BUFFER(wireDataBuffer, wireDataSize);
+		read_view_t view = make_read_view(wireDataBuffer, wireDataBuffer + wireDataSize);
+
+		numAddresses = parse_u1be(&view);
+		VALIDATE(numAddresses > 0, ERR_INVALID_DATA);
+		VALIDATE(numAddresses <= CHECK_OWNERSHIP_MAX_ADDRESSES_PER_APDU, ERR_INVALID_DATA);
+		VALIDATE(numAddresses <= ctx->numAddresses - ctx->currentAddress, ERR_INVALID_DATA);
+
+		for (size_t i = 0; i < numAddresses; i++) {
+			const size_t addressSize = parse_u1be(&view);
+			VALIDATE(addressSize > 0, ERR_INVALID_DATA);
+			VALIDATE(addressSize <= MAX_ADDRESS_SIZE, ERR_INVALID_DATA);
+			const uint8_t* addressBuffer = view_borrowBuffer(&view, addressSize);
+
+			size_t candidate = 0;
+			if (_findOwner(addressBuffer, addressSize, &candidate)) {
+				ownedBitmap |= (uint8_t) (1u << i);
+				owners[numOwned] = candidate;
+				numOwned++;
+			}
+		}
+		VALIDATE(view_remainingSize(&view) == 0, ERR_INVALID_DATA);
+	}
+	{
+		// the request data are not needed anymore
+		write_view_t response = make_response_view();
+		view_appendBuffer(&response, &ownedBitmap, SIZEOF(ownedBitmap));
+
+		for (size_t i = 0; i < numOwned; i++) {
+			bip44_path_t pathSpec;
+			_getCandidatePath(owners[i], &pathSpec);
+
+			for (size_t level = BIP44_I_ACCOUNT; level <= BIP44_I_ADDRESS; level++) {
+				uint8_t buffer[4] = {0};
+				u4be_write(buffer, pathSpec.path[level]);
+				view_appendBuffer(&response, buffer, sizeof(buffer));
+			}
+		}
+		TRACE("%u of %u addresses owned", (unsigned) numOwned, (unsigned) numAddresses);
+		view_sendResponse(SUCCESS, &response);
+	}
+	ui_displayBusy(); // displays dots, called only after I/O to avoid freezing
+
+	ctx->currentAddress += numAddresses;
+	TRACE("Checked addresses: %u / %u", ctx->currentAddress, ctx->numAddresses);
+
+	if (ctx->currentAddress == ctx->numAddresses) {
+		advanceStage();
+	}
+}
+
+// ============================== MAIN HANDLER ==============================
+
+typedef void subhandler_fn_t(uint8_t p2, const uint8_t* dataBuffer, size_t dataSize);
+
+static subhandler_fn_t* lookup_subhandler(uint8_t p1)
+{
+	switch (p1) {
+#define  CASE(P1, HANDLER) case P1: return HANDLER;
+#define  DEFAULT(HANDLER)  default: return HANDLER;
+		CASE(0x01, checkOwnership_handleInitAPDU);
+		CASE(0x02, checkOwnership_handleCheckAPDU);
+		DEFAULT(NULL)
+#undef   CASE
+#undef   DEFAULT
+	}
+}
+
+void checkOwnership_handleAPDU(
+        uint8_t p1,
+        uint8_t p2,
+        const uint8_t* wireDataBuffer,
+        size_t wireDataSize,
+        bool isNewCall
+)
+{
+	ASSERT(wireDataSize < BUFFER_SIZE_PARANOIA);
+
+	if (isNewCall) {
+		explicit_bzero(ctx, SIZEOF(*ctx));
+		ctx->stage = CHECK_OWNERSHIP_STAGE_INIT;
+	}
+
+	subhandler_fn_t* subhandler = lookup_subhandler(p1);
+	VALIDATE(subhandler != NULL, ERR_INVALID_REQUEST_PARAMETERS);
+	subhandler(p2, wireDataBuffer, wireDataSize);
+}
@@ -0,0 +1,60 @@
+#ifndef H_CARDANO_APP_CHECK_OWNERSHIP
+#define H_CARDANO_APP_CHECK_OWNERSHIP
+
+#include "common.h"
+#include "handlers.h"
+#include "bip44.h"
+#include "keyDerivation.h"
+
+// the number of candidate keys (accounts x chains x addresses)
+// derived in advance for the whole instruction
+#if defined(TARGET_NANOS)
+#define CHECK_OWNERSHIP_MAX_CANDIDATES 40
+#else
+#define CHECK_OWNERSHIP_MAX_CANDIDATES 200
+#endif
+
+// the beginning of the candidate key hash (or the end of its Byron address)
+#define CHECK_OWNERSHIP_TAG_SIZE 4
+
+#define CHECK_OWNERSHIP_MAX_ADDRESSES 10000
+#define CHECK_OWNERSHIP_MAX_ADDRESSES_PER_APDU 8
+
+// external and internal chain
+#define CHECK_OWNERSHIP_NUM_CHAINS 2
+
+typedef enum {
+	CHECK_OWNERSHIP_STAGE_NONE = 0,
+	CHECK_OWNERSHIP_STAGE_INIT = 20,
+	CHECK_OWNERSHIP_STAGE_CHECK = 40,
+} check_ownership_stage_t;
+
+typedef struct {
+	check_ownership_stage_t stage;
+
+	// the search window
+	uint32_t purpose;
+	uint32_t firstAccount;
+	uint8_t numAccounts;
+	uint32_t firstAddress;
+	uint16_t numAddressesPerChain;
+	uint32_t protocolMagic; // for Byron addresses
+
+	uint16_t numAddresses;
+	uint16_t currentAddress;
+
+	// derived one by one, partly in the background while the user reviews the request
+	uint16_t numCandidateTags;
+	uint8_t candidateTags[CHECK_OWNERSHIP_MAX_CANDIDATES][CHECK_OWNERSHIP_TAG_SIZE];
+
+	// the key of the chain the last Shelley candidate belongs to
+	bool isChainKeyValid;
+	uint16_t chainKeyCandidate; // the first candidate in the chain
+	extendedPublicKey_t chainKey;
+
+	int ui_step;
+} ins_check_ownership_context_t;
+
+handler_fn_t checkOwnership_handleAPDU;
+
+#endif // H_CARDANO_APP_CHECK_OWNERSHIP
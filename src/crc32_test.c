@@ -4,6 +4,44 @@
 #include "hexUtils.h"
 #include "testUtils.h"
 
+// the previous bit-by-bit implementation
+// https://www.hackersdelight.org/hdcodetxt/crc.c.txt option crc32b
+static uint32_t crc32_reference(const uint8_t* inBuffer, size_t inSize)
+{
+	uint32_t crc = 0xFFFFFFFF;
+	for (size_t i = 0; i < inSize; i++) {
+		crc = crc ^ inBuffer[i];
+		for (uint32_t j = 0; j < 8; j++) {
+			uint32_t mask = -(crc & 1);
+			crc = (crc >> 1) ^ (0xEDB88320 & mask);
+		}
+	}
+	return ~crc;
+}
+
+// compares crc32 with the reference on pseudo-random inputs of all sizes
+// up to beyond the maximal Byron address payload
+static void testcase_crc32_differential()
+{
+	PRINTF("testcase_crc32_differential\n");
+	uint8_t buffer[200] = {0};
+	uint32_t state = 0x12345678; // xorshift32
+	for (size_t i = 0; i < SIZEOF(buffer); i++) {
+		state ^= state << 13;
+		state ^= state >> 17;
+		state ^= state << 5;
+		buffer[i] = (uint8_t) state;
+	}
+
+	for (size_t size = 0; size <= SIZEOF(buffer); size++) {
+		EXPECT_EQ(crc32(buffer, size), crc32_reference(buffer, size));
+		// a different alignment of the data
+		if (size > 0) {
+			EXPECT_EQ(crc32(buffer + 1, size - 1), crc32_reference(buffer + 1, size - 1));
+		}
+	}
+}
+
 void run_crc32_test()
 {
 	const struct {
@@ -33,6 +71,7 @@ void run_crc32_test()
 
 		EXPECT_EQ(result, it->expected);
 	}
+	testcase_crc32_differential();
 }
 
 #endif // DEVEL
@@ -0,0 +1,166 @@
+#include "derivationCache.h"
+#include "hash.h"
+#include "softDerivation.h"
+#include "xpubCache.h"
+#include "securityPolicy.h"
+
+static struct {
+	derivation_cache_entry_t entries[DERIVATION_CACHE_SIZE];
+	size_t numEntries;
+	size_t nextEntry; // the oldest one is replaced when full
+
+	// the account the last derived address-level key belongs to,
+	// kept aside so that the keys derived from it do not evict it
+	bool isAccountKeyValid;
+	bip44_path_t accountPath;
+	extendedPublicKey_t accountKey;
+
+	#ifdef DEVEL
+	uint32_t numHits;
+	uint32_t numMisses;
+	uint32_t numAccountMisses;
+	#endif // DEVEL
+} cache;
+
+void derivationCache_reset()
+{
+	#ifdef DEVEL
+	if (cache.numHits + cache.numMisses > 0) {
+		TRACE(
+		        "Derivation cache: %u hits, %u misses, %u account misses",
+		        (unsigned) cache.numHits, (unsigned) cache.numMisses, (unsigned) cache.numAccountMisses
+		);
+	}
+	#endif // DEVEL
+
+	explicit_bzero(&cache, SIZEOF(cache));
+}
+
+static void _deriveExtendedPublicKey(const bip44_path_t* pathSpec, extendedPublicKey_t* out);
+
+static void _getAccountKey(const bip44_path_t* accountPath, extendedPublicKey_t* out)
+{
+	if (cache.isAccountKeyValid && bip44_pathsEqual(&cache.accountPath, accountPath)) {
+		*out = cache.accountKey;
+		return;
+	}
+
+	#ifdef DEVEL
+	cache.numAccountMisses++;
+	#endif // DEVEL
+
+	// derive first, the slot must not be left half-filled if it throws
+	extendedPublicKey_t accountKey;
+	_deriveExtendedPublicKey(accountPath, &accountKey);
+
+	cache.accountPath = *accountPath;
+	cache.accountKey = accountKey;
+	cache.isAccountKeyValid = true;
+
+	*out = accountKey;
+}
+
+static void _deriveExtendedPublicKey(const bip44_path_t* pathSpec, extendedPublicKey_t* out)
+{
+	if (!bip44_isDerivableFromAccount(pathSpec)) {
+		// account keys might have been stored in NVM by a previous run of the app
+		if (xpubCache_get(pathSpec, out)) {
+			// the same check as in derivePrivateKey
+			ASSERT(policyForDerivePrivateKey(pathSpec) != POLICY_DENY);
+			return;
+		}
+		deriveExtendedPublicKey(pathSpec, out);
+		xpubCache_store(pathSpec, out);
+		return;
+	}
+
+	// the same check as in derivePrivateKey, the key could be derived publicly even for a bad path
+	ASSERT(policyForDerivePrivateKey(pathSpec) != POLICY_DENY);
+
+	// one derivation from the seed is shared by all keys of the account
+	bip44_path_t accountPath = *pathSpec;
+	accountPath.length = 3;
+	extendedPublicKey_t accountKey;
+	_getAccountKey(&accountPath, &accountKey);
+
+	extendedPublicKey_t chainKey;
+	softDerivation_deriveChildPublicKey(&accountKey, pathSpec->path[3], &chainKey);
+	softDerivation_deriveChildPublicKey(&chainKey, pathSpec->path[4], out);
+}
+
+static derivation_cache_entry_t* _getEntry(const bip44_path_t* pathSpec)
+{
+	ASSERT(cache.numEntries <= DERIVATION_CACHE_SIZE);
+
+	for (size_t i = 0; i < cache.numEntries; i++) {
+		if (bip44_pathsEqual(&cache.entries[i].path, pathSpec)) {
+			#ifdef DEVEL
+			cache.numHits++;
+			#endif // DEVEL
+			return &cache.entries[i];
+		}
+	}
+
+	#ifdef DEVEL
+	cache.numMisses++;
+	#endif // DEVEL
+
+	// derive first, the entry must not be left half-filled if it throws
+	extendedPublicKey_t extPubKey;
+	_deriveExtendedPublicKey(pathSpec, &extPubKey);
+
+	ASSERT(cache.nextEntry < DERIVATION_CACHE_SIZE);
+	derivation_cache_entry_t* entry = &cache.entries[cache.nextEntry];
+	explicit_bzero(entry, SIZEOF(*entry));
+	entry->path = *pathSpec;
+	entry->extPubKey = extPubKey;
+
+	cache.nextEntry = (cache.nextEntry + 1) % DERIVATION_CACHE_SIZE;
+	cache.numEntries = MIN(cache.numEntries + 1, DERIVATION_CACHE_SIZE);
+
+	return entry;
+}
+
+void derivationCache_deriveExtendedPublicKey(const bip44_path_t* pathSpec, extendedPublicKey_t* out)
+{
+	_deriveExtendedPublicKey(pathSpec, out);
+}
+
+void derivationCache_getExtendedPublicKey(const bip44_path_t* pathSpec, extendedPublicKey_t* out)
+{
+	const derivation_cache_entry_t* entry = _getEntry(pathSpec);
+	*out = entry->extPubKey;
+}
+
+void derivationCache_getKeyHash(const bip44_path_t* pathSpec, uint8_t* hash, size_t hashSize)
+{
+	ASSERT(hashSize == ADDRESS_KEY_HASH_LENGTH);
+
+	derivation_cache_entry_t* entry = _getEntry(pathSpec);
+	if (!entry->isKeyHashStored) {
+		STATIC_ASSERT(SIZEOF(entry->keyHash) * 8 == 224, "wrong key hash size");
+		blake2b_224_hash(
+		        entry->extPubKey.pubKey, SIZEOF(entry->extPubKey.pubKey),
+		        entry->keyHash, SIZEOF(entry->keyHash)
+		);
+		entry->isKeyHashStored = true;
+	}
+	memmove(hash, entry->keyHash, SIZEOF(entry->keyHash));
+}
+
+#ifdef DEVEL
+uint32_t derivationCache_numHits()
+{
+	return cache.numHits;
+}
+
+uint32_t derivationCache_numMisses()
+{
+	return cache.numMisses;
+}
+
+uint32_t derivationCache_numAccountMisses()
+{
+	return cache.numAccountMisses;
+}
+#endif // DEVEL
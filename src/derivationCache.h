@@ -0,0 +1,53 @@
+#ifndef H_CARDANO_APP_DERIVATION_CACHE
+#define H_CARDANO_APP_DERIVATION_CACHE
+
+#include "common.h"
+#include "bip44.h"
+#include "keyDerivation.h"
+#include "cardano.h"
+
+// Keeps public keys derived during a single instruction
+// (e.g. the same change output and staking key paths appear many times in a tx).
+// Only public data are stored. The cache is wiped whenever a new instruction starts.
+//
+// Keys of the form m/purpose'/coin_type'/account'/chain/address are derived publicly
+// from the account key, see softDerivation.h. The account key is kept in a slot of its own,
+// so that the keys derived from it do not evict it (the cache is tiny on Nano S).
+// Account keys are also kept across runs of the app, see xpubCache.h.
+
+#if defined(TARGET_NANOS)
+#define DERIVATION_CACHE_SIZE 2
+#else
+#define DERIVATION_CACHE_SIZE 8
+#endif
+
+typedef struct {
+	bip44_path_t path;
+	extendedPublicKey_t extPubKey;
+	bool isKeyHashStored;
+	uint8_t keyHash[ADDRESS_KEY_HASH_LENGTH];
+} derivation_cache_entry_t;
+
+void derivationCache_reset();
+
+// same as deriveExtendedPublicKey
+void derivationCache_getExtendedPublicKey(const bip44_path_t* pathSpec, extendedPublicKey_t* out);
+
+// the key itself is not cached (e.g. bulk export of many different keys),
+// only the account key it is derived from
+void derivationCache_deriveExtendedPublicKey(const bip44_path_t* pathSpec, extendedPublicKey_t* out);
+
+// blake2b-224 hash of the public key
+void derivationCache_getKeyHash(const bip44_path_t* pathSpec, uint8_t* hash, size_t hashSize);
+
+
+#ifdef DEVEL
+uint32_t derivationCache_numHits();
+uint32_t derivationCache_numMisses();
+// hits and misses count the keys requested, account keys are counted separately
+uint32_t derivationCache_numAccountMisses();
+
+void run_derivationCache_test();
+#endif // DEVEL
+
+#endif // H_CARDANO_APP_DERIVATION_CACHE
@@ -0,0 +1,105 @@
+#ifdef DEVEL
+
+#include "derivationCache.h"
+#include "hash.h"
+#include "testUtils.h"
+
+static void pathSpec_init(bip44_path_t* pathSpec, uint32_t account, uint32_t address)
+{
+	const uint32_t path[] = {HARDENED_BIP32 + 1852, HARDENED_BIP32 + 1815, HARDENED_BIP32 + account, 0, address};
+	pathSpec->length = ARRAY_LEN(path);
+	memmove(pathSpec->path, path, SIZEOF(path));
+}
+
+static void testCachedKeys()
+{
+	PRINTF("testcase_derivationCache\n");
+	derivationCache_reset();
+
+	bip44_path_t pathSpec;
+	pathSpec_init(&pathSpec, 0, 1);
+
+	extendedPublicKey_t expected;
+	deriveExtendedPublicKey(&pathSpec, &expected);
+	uint8_t expectedHash[ADDRESS_KEY_HASH_LENGTH] = {0};
+	blake2b_224_hash(expected.pubKey, SIZEOF(expected.pubKey), expectedHash, SIZEOF(expectedHash));
+
+	for (size_t i = 0; i < 2; i++) {
+		extendedPublicKey_t extPubKey;
+		derivationCache_getExtendedPublicKey(&pathSpec, &extPubKey);
+		EXPECT_EQ_BYTES(&extPubKey, &expected, SIZEOF(expected));
+
+		uint8_t hash[ADDRESS_KEY_HASH_LENGTH] = {0};
+		derivationCache_getKeyHash(&pathSpec, hash, SIZEOF(hash));
+		EXPECT_EQ_BYTES(hash, expectedHash, SIZEOF(expectedHash));
+	}
+	EXPECT_EQ(derivationCache_numMisses(), 1);
+	EXPECT_EQ(derivationCache_numHits(), 3);
+	EXPECT_EQ(derivationCache_numAccountMisses(), 1);
+
+	derivationCache_reset();
+	EXPECT_EQ(derivationCache_numMisses(), 0);
+	EXPECT_EQ(derivationCache_numHits(), 0);
+	EXPECT_EQ(derivationCache_numAccountMisses(), 0);
+}
+
+static void testReplacement()
+{
+	PRINTF("testcase_derivationCache replacement\n");
+	derivationCache_reset();
+
+	bip44_path_t pathSpec;
+	extendedPublicKey_t extPubKey;
+	// one more path than fits, the first one gets replaced
+	for (uint32_t i = 0; i <= DERIVATION_CACHE_SIZE; i++) {
+		pathSpec_init(&pathSpec, 0, i);
+		derivationCache_getExtendedPublicKey(&pathSpec, &extPubKey);
+	}
+	EXPECT_EQ(derivationCache_numMisses(), DERIVATION_CACHE_SIZE + 1);
+
+	pathSpec_init(&pathSpec, 0, DERIVATION_CACHE_SIZE);
+	derivationCache_getExtendedPublicKey(&pathSpec, &extPubKey);
+	EXPECT_EQ(derivationCache_numHits(), 1);
+
+	pathSpec_init(&pathSpec, 0, 0);
+	derivationCache_getExtendedPublicKey(&pathSpec, &extPubKey);
+	EXPECT_EQ(derivationCache_numMisses(), DERIVATION_CACHE_SIZE + 2);
+
+	derivationCache_reset();
+}
+
+static void testAccountKeyKept()
+{
+	PRINTF("testcase_derivationCache account key\n");
+	derivationCache_reset();
+
+	bip44_path_t pathSpec;
+	extendedPublicKey_t extPubKey;
+	// sibling keys evict each other, but not the account key they are derived from
+	for (uint32_t i = 0; i < 3 * DERIVATION_CACHE_SIZE; i++) {
+		pathSpec_init(&pathSpec, 0, i);
+		derivationCache_getExtendedPublicKey(&pathSpec, &extPubKey);
+
+		extendedPublicKey_t expected;
+		deriveExtendedPublicKey(&pathSpec, &expected);
+		EXPECT_EQ_BYTES(&extPubKey, &expected, SIZEOF(expected));
+	}
+	EXPECT_EQ(derivationCache_numMisses(), 3 * DERIVATION_CACHE_SIZE);
+	EXPECT_EQ(derivationCache_numAccountMisses(), 1);
+
+	// a key of another account replaces it
+	pathSpec_init(&pathSpec, 1, 0);
+	derivationCache_getExtendedPublicKey(&pathSpec, &extPubKey);
+	EXPECT_EQ(derivationCache_numAccountMisses(), 2);
+
+	derivationCache_reset();
+}
+
+void run_derivationCache_test()
+{
+	testCachedKeys();
+	testReplacement();
+	testAccountKeyKept();
+}
+
+#endif // DEVEL
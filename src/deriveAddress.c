@@ -8,25 +8,58 @@
 #include "base58.h"
 #include "bech32.h"
 #include "bufView.h"
+#include "backgroundTasks.h"
 
 static uint16_t RESPONSE_READY_MAGIC = 11223;
 
 static ins_derive_address_context_t* ctx = &(instructionState.deriveAddressContext);
 
 enum {
-	P1_RETURN  = 0x01,
-	P1_DISPLAY = 0x02,
+	P1_RETURN       = 0x01,
+	P1_DISPLAY      = 0x02,
+	P1_RETURN_RANGE = 0x03,
 };
 
+__noinline_due_to_stack__
 static void prepareResponse()
 {
-	ctx->address.size = deriveAddress(
-	                            &ctx->addressParams,
-	                            ctx->address.buffer, SIZEOF(ctx->address.buffer)
-	                    );
+	uint8_t addressBuffer[MAX_ADDRESS_SIZE] = {0};
+	const size_t addressSize = deriveAddress(
+	                                   &ctx->addressParams,
+	                                   addressBuffer, SIZEOF(addressBuffer)
+	                           );
+	ASSERT(addressSize <= SIZEOF(ctx->address.buffer));
+
+	// stored at once, the response is not ready if the derivation throws
+	memmove(ctx->address.buffer, addressBuffer, addressSize);
+	ctx->address.size = addressSize;
 	ctx->responseReadyMagic = RESPONSE_READY_MAGIC;
 }
 
+static void ensureResponseReady()
+{
+	if (ctx->responseReadyMagic != RESPONSE_READY_MAGIC) {
+		prepareResponse();
+	}
+	ASSERT(ctx->responseReadyMagic == RESPONSE_READY_MAGIC);
+}
+
+// the address is derived while the user reviews the first screens
+static bool prepareResponse_backgroundTask()
+{
+	ensureResponseReady();
+	return false;
+}
+
+static void scheduleResponse(security_policy_t policy)
+{
+	if (policy == POLICY_ALLOW_WITHOUT_PROMPT) {
+		prepareResponse();
+	} else {
+		backgroundTasks_schedule(prepareResponse_backgroundTask);
+	}
+}
+
 
 static void deriveAddress_return_ui_runStep();
 enum {
@@ -46,7 +79,7 @@ static void deriveAddress_handleReturn()
 	TRACE("Policy: %d", (int) policy);
 	ENSURE_NOT_DENIED(policy);
 
-	prepareResponse();
+	scheduleResponse(policy);
 
 	switch (policy) {
 #define  CASE(POLICY, STEP) case POLICY: {ctx->ui_step=STEP; break;}
@@ -63,7 +96,6 @@ static void deriveAddress_handleReturn()
 static void deriveAddress_return_ui_runStep()
 {
 	TRACE("step %d\n", ctx->ui_step);
-	ASSERT(ctx->responseReadyMagic == RESPONSE_READY_MAGIC);
 	ui_callback_fn_t* this_fn = deriveAddress_return_ui_runStep;
 
 	UI_STEP_BEGIN(ctx->ui_step, this_fn);
@@ -97,6 +129,7 @@ static void deriveAddress_return_ui_runStep()
 		);
 	}
 	UI_STEP(RETURN_UI_STEP_RESPOND) {
+		ensureResponseReady();
 		ctx->responseReadyMagic = 0;
 		ASSERT(ctx->address.size <= SIZEOF(ctx->address.buffer));
 
@@ -107,6 +140,231 @@ static void deriveAddress_return_ui_runStep()
 }
 
 
+static void deriveAddress_returnRange_ui_runStep();
+enum {
+	RETURN_RANGE_UI_STEP_WARNING = 300,
+	RETURN_RANGE_UI_STEP_BEGIN,
+	RETURN_RANGE_UI_STEP_SPENDING_PATH_FIRST,
+	RETURN_RANGE_UI_STEP_SPENDING_PATH_LAST,
+	RETURN_RANGE_UI_STEP_STAKING_INFO,
+	RETURN_RANGE_UI_STEP_CONFIRM,
+	RETURN_RANGE_UI_STEP_RESPOND,
+	RETURN_RANGE_UI_STEP_INVALID,
+};
+
+static void _setSpendingKeyIndex(addressParams_t* addressParams, uint32_t index)
+{
+	ASSERT(determineSpendingChoice(addressParams->type) == SPENDING_PATH);
+	ASSERT(addressParams->spendingKeyPath.length == BIP44_I_ADDRESS + 1);
+
+	addressParams->spendingKeyPath.path[BIP44_I_ADDRESS] = index;
+}
+
+// the staking key hash is the same for all the addresses in the range,
+// so it is derived only once instead of once per address
+__noinline_due_to_stack__
+static void _resolveStakingKeyHash()
+{
+	if (ctx->addressParams.stakingDataSource != STAKING_KEY_PATH) return;
+
+	uint8_t stakingKeyHash[ADDRESS_KEY_HASH_LENGTH] = {0};
+	bip44_pathToKeyHash(&ctx->addressParams.stakingKeyPath, stakingKeyHash, SIZEOF(stakingKeyHash));
+
+	// overwrites the staking key path (in a union), the address stays the same
+	STATIC_ASSERT(SIZEOF(ctx->addressParams.stakingKeyHash) == ADDRESS_KEY_HASH_LENGTH, "bad staking key hash size");
+	memmove(ctx->addressParams.stakingKeyHash, stakingKeyHash, SIZEOF(stakingKeyHash));
+	ctx->addressParams.stakingDataSource = STAKING_KEY_HASH;
+}
+
+static void _deriveNextRangeAddress()
+{
+	ASSERT(ctx->range.isActive);
+	ASSERT(!ctx->range.isAddressPending);
+	ASSERT(ctx->range.remainingCount > 0);
+
+	_setSpendingKeyIndex(&ctx->addressParams, ctx->range.nextIndex);
+	ctx->address.size = deriveAddress(
+	                            &ctx->addressParams,
+	                            ctx->address.buffer, SIZEOF(ctx->address.buffer)
+	                    );
+	ctx->range.nextIndex++;
+	ctx->range.isAddressPending = true;
+}
+
+// sends as many addresses as fit into the response
+// each of them prefixed by its size
+__noinline_due_to_stack__
+static void _sendRangeAddresses()
+{
+	ASSERT(ctx->range.isActive);
+
+	write_view_t response = make_response_view();
+	while (ctx->range.remainingCount > 0) {
+		if (!ctx->range.isAddressPending) {
+			_deriveNextRangeAddress();
+		}
+		ASSERT(ctx->address.size <= MAX_ADDRESS_SIZE);
+		STATIC_ASSERT(MAX_ADDRESS_SIZE <= UINT8_MAX, "address size does not fit into one byte");
+		const uint8_t addressSize = (uint8_t) ctx->address.size;
+
+		if (view_remainingSize(&response) < 1 + (size_t) addressSize) {
+			// kept for the next response
+			break;
+		}
+		view_appendBuffer(&response, &addressSize, 1);
+		view_appendBuffer(&response, ctx->address.buffer, addressSize);
+
+		ctx->range.isAddressPending = false;
+		ctx->range.remainingCount--;
+	}
+	// the response fits at least one address
+	ASSERT(view_processedSize(&response) > 0);
+
+	TRACE("Addresses remaining: %u", (unsigned) ctx->range.remainingCount);
+	view_sendResponse(SUCCESS, &response);
+
+	if (ctx->range.remainingCount > 0) {
+		ui_displayBusy(); // displays dots, called only after I/O to avoid freezing
+	} else {
+		ctx->range.isActive = false;
+		ui_idle();
+	}
+}
+
+// for the policies returned by policyForReturnDeriveAddress
+static security_policy_t _stricterPolicy(security_policy_t policy1, security_policy_t policy2)
+{
+	const security_policy_t policies[] = {
+		// from the strictest one
+		POLICY_DENY,
+		POLICY_PROMPT_WARN_UNUSUAL,
+		POLICY_PROMPT_BEFORE_RESPONSE,
+		POLICY_ALLOW_WITHOUT_PROMPT,
+	};
+	ITERATE(it, policies) {
+		if (policy1 == *it || policy2 == *it) {
+			return *it;
+		}
+	}
+	ASSERT(false);
+	return POLICY_DENY;
+}
+
+// the spending path of the address in the range with the given index
+static void _displayRangeSpendingPath(const char* firstLine, uint32_t index, ui_callback_fn_t* callback)
+{
+	bip44_path_t spendingPath = ctx->addressParams.spendingKeyPath;
+	ASSERT(spendingPath.length == BIP44_I_ADDRESS + 1);
+	spendingPath.path[BIP44_I_ADDRESS] = index;
+
+	ui_displayPathScreen(firstLine, &spendingPath, callback);
+}
+
+static void deriveAddress_handleReturnRange(uint32_t firstIndex, uint32_t count)
+{
+	VALIDATE(determineSpendingChoice(ctx->addressParams.type) == SPENDING_PATH, ERR_INVALID_DATA);
+	VALIDATE(ctx->addressParams.spendingKeyPath.length == BIP44_I_ADDRESS + 1, ERR_INVALID_DATA);
+
+	VALIDATE(count > 0, ERR_INVALID_DATA);
+	VALIDATE(!isHardened(firstIndex), ERR_INVALID_DATA);
+	// the last index must not be hardened
+	VALIDATE(count - 1 < HARDENED_BIP32 - firstIndex, ERR_INVALID_DATA);
+
+	// the paths differ only in the address index,
+	// so checking both ends of the range covers all of them
+	security_policy_t policy = POLICY_DENY;
+	{
+		_setSpendingKeyIndex(&ctx->addressParams, firstIndex);
+		const security_policy_t firstPolicy = policyForReturnDeriveAddress(&ctx->addressParams);
+		ENSURE_NOT_DENIED(firstPolicy);
+
+		_setSpendingKeyIndex(&ctx->addressParams, firstIndex + (count - 1));
+		const security_policy_t lastPolicy = policyForReturnDeriveAddress(&ctx->addressParams);
+		ENSURE_NOT_DENIED(lastPolicy);
+
+		policy = _stricterPolicy(firstPolicy, lastPolicy);
+		TRACE("Policy: %d", (int) policy);
+	}
+
+	// the template shows the first address of the range
+	_setSpendingKeyIndex(&ctx->addressParams, firstIndex);
+	ctx->range.nextIndex = firstIndex;
+	ctx->range.remainingCount = count;
+
+	switch (policy) {
+#define  CASE(POLICY, STEP) case POLICY: {ctx->ui_step=STEP; break;}
+		CASE(POLICY_PROMPT_WARN_UNUSUAL,    RETURN_RANGE_UI_STEP_WARNING);
+		CASE(POLICY_PROMPT_BEFORE_RESPONSE, RETURN_RANGE_UI_STEP_BEGIN);
+		CASE(POLICY_ALLOW_WITHOUT_PROMPT,   RETURN_RANGE_UI_STEP_RESPOND);
+#undef   CASE
+	default:
+		THROW(ERR_NOT_IMPLEMENTED);
+	}
+	deriveAddress_returnRange_ui_runStep();
+}
+
+static void deriveAddress_returnRange_ui_runStep()
+{
+	TRACE("step %d\n", ctx->ui_step);
+	ui_callback_fn_t* this_fn = deriveAddress_returnRange_ui_runStep;
+
+	UI_STEP_BEGIN(ctx->ui_step, this_fn);
+
+	UI_STEP(RETURN_RANGE_UI_STEP_WARNING) {
+		ui_displayPaginatedText(
+		        "Unusual request",
+		        "Proceed with care",
+		        this_fn
+		);
+	}
+	UI_STEP(RETURN_RANGE_UI_STEP_BEGIN) {
+		char body[50] = {0};
+		explicit_bzero(body, SIZEOF(body));
+		STATIC_ASSERT(sizeof(ctx->range.remainingCount) <= sizeof(unsigned), "oversized type for %u");
+		STATIC_ASSERT(!IS_SIGNED(ctx->range.remainingCount), "signed type for %u");
+		snprintf(body, SIZEOF(body), "%u addresses", ctx->range.remainingCount);
+		// make sure all the information is displayed to the user
+		ASSERT(strlen(body) + 1 < SIZEOF(body));
+
+		ui_displayPaginatedText("Export", body, this_fn);
+	}
+	UI_STEP(RETURN_RANGE_UI_STEP_SPENDING_PATH_FIRST) {
+		ASSERT(!ctx->range.isActive); // nothing derived yet
+		_displayRangeSpendingPath("First spending path", ctx->range.nextIndex, this_fn);
+	}
+	UI_STEP(RETURN_RANGE_UI_STEP_SPENDING_PATH_LAST) {
+		ASSERT(ctx->range.remainingCount > 0);
+		const uint32_t lastIndex = ctx->range.nextIndex + (ctx->range.remainingCount - 1);
+		_displayRangeSpendingPath("Last spending path", lastIndex, this_fn);
+	}
+	UI_STEP(RETURN_RANGE_UI_STEP_STAKING_INFO) {
+		ui_displayStakingInfoScreen(&ctx->addressParams, this_fn);
+	}
+	UI_STEP(RETURN_RANGE_UI_STEP_CONFIRM) {
+		ui_displayPrompt(
+		        "Confirm",
+		        "export addresses?",
+		        this_fn,
+		        respond_with_user_reject
+		);
+	}
+	UI_STEP(RETURN_RANGE_UI_STEP_RESPOND) {
+		_resolveStakingKeyHash();
+		ctx->range.isActive = true;
+
+		_sendRangeAddresses();
+	}
+	UI_STEP_END(RETURN_RANGE_UI_STEP_INVALID);
+}
+
+static void deriveAddress_handleReturnRangeContinuation()
+{
+	VALIDATE(ctx->range.isActive, ERR_INVALID_STATE);
+
+	_sendRangeAddresses();
+}
+
+
 static void deriveAddress_display_ui_runStep();
 enum {
 	DISPLAY_UI_STEP_WARNING = 200,
@@ -127,7 +385,7 @@ static void deriveAddress_handleDisplay()
 	TRACE("Policy: %d", (int) policy);
 	ENSURE_NOT_DENIED(policy);
 
-	prepareResponse();
+	scheduleResponse(policy);
 
 	switch (policy) {
 #define  CASE(policy, step) case policy: {ctx->ui_step=step; break;}
@@ -142,7 +400,6 @@ static void deriveAddress_handleDisplay()
 
 static void deriveAddress_display_ui_runStep()
 {
-	ASSERT(ctx->responseReadyMagic == RESPONSE_READY_MAGIC);
 	ui_callback_fn_t* this_fn = deriveAddress_display_ui_runStep;
 
 	UI_STEP_BEGIN(ctx->ui_step, this_fn);
@@ -172,6 +429,7 @@ static void deriveAddress_display_ui_runStep()
 		ui_displayStakingInfoScreen(&ctx->addressParams, this_fn);
 	}
 	UI_STEP(DISPLAY_UI_STEP_ADDRESS) {
+		ensureResponseReady();
 		ASSERT(ctx->address.size <= SIZEOF(ctx->address.buffer));
 		ui_displayAddressScreen(
 		        "Address",
@@ -205,16 +463,31 @@ void deriveAddress_handleAPDU(
 	VALIDATE(p2 == P2_UNUSED, ERR_INVALID_REQUEST_PARAMETERS);
 	TRACE_BUFFER(wireDataBuffer, wireDataSize);
 
+	if ((p1 == P1_RETURN_RANGE) && !isNewCall) {
+		// the following messages of a range only ask for more addresses
+		VALIDATE(wireDataSize == 0, ERR_INVALID_DATA);
+		deriveAddress_handleReturnRangeContinuation();
+		return;
+	}
+
 	// Initialize state
 	if (isNewCall) {
 		explicit_bzero(ctx, SIZEOF(*ctx));
 	}
+	VALIDATE(!ctx->range.isActive, ERR_INVALID_STATE);
 	ctx->responseReadyMagic = 0;
 
 	read_view_t view = make_read_view(wireDataBuffer, wireDataBuffer + wireDataSize);
 
 	view_parseAddressParams(&view, &ctx->addressParams);
 
+	uint32_t firstIndex = 0, count = 0;
+	if (p1 == P1_RETURN_RANGE) {
+		firstIndex = parse_u4be(&view);
+		count = parse_u4be(&view);
+		TRACE("Address range: %u + %u", (unsigned) firstIndex, (unsigned) count);
+	}
+
 	VALIDATE(view_remainingSize(&view) == 0, ERR_INVALID_DATA);
 
 	switch (p1) {
@@ -222,6 +495,10 @@ void deriveAddress_handleAPDU(
 		CASE(P1_RETURN,  deriveAddress_handleReturn);
 		CASE(P1_DISPLAY, deriveAddress_handleDisplay);
 #undef   CASE
+	case P1_RETURN_RANGE:
+		deriveAddress_handleReturnRange(firstIndex, count);
+		break;
+
 	default:
 		THROW(ERR_INVALID_REQUEST_PARAMETERS);
 	}
@@ -15,6 +15,13 @@ typedef struct {
 		uint8_t buffer[MAX_ADDRESS_SIZE];
 		size_t size;
 	} address;
+	// addresses with consecutive spending key indices, see P1_RETURN_RANGE
+	struct {
+		bool isActive;
+		uint32_t nextIndex; // of the next address to be derived
+		uint32_t remainingCount; // includes the pending address
+		bool isAddressPending; // derived into address, but did not fit into the last response
+	} range;
 	int ui_step;
 } ins_derive_address_context_t;
 
@@ -3,6 +3,7 @@
 #include "uiHelpers.h"
 #include "uiScreens.h"
 #include "getPublicKeys.h"
+#include "derivationCache.h"
 
 static int16_t RESPONSE_READY_MAGIC = 23456;
 
@@ -91,9 +92,15 @@ static void getPublicKeys_respondOneKey_ui_runStep()
 	}
 	UI_STEP(GET_KEY_UI_STEP_RESPOND) {
 		ASSERT(ctx->responseReadyMagic == RESPONSE_READY_MAGIC);
-
-		io_send_buf(SUCCESS, (uint8_t*) &ctx->extPubKey, SIZEOF(ctx->extPubKey));
 		ctx->responseReadyMagic = 0; // just for safety
+
+		// the key is derived only when responding and written directly into the response
+		write_view_t response = make_response_view();
+		extendedPublicKey_t* extPubKey = (extendedPublicKey_t*) response.ptr;
+		view_skipBytes(&response, SIZEOF(*extPubKey));
+		derivationCache_deriveExtendedPublicKey(&ctx->pathSpec, extPubKey);
+
+		view_sendResponse(SUCCESS, &response);
 		ui_displayBusy(); // displays dots, called only after I/O to avoid freezing
 
 		ctx->currentPath++;
@@ -105,7 +112,7 @@ static void getPublicKeys_respondOneKey_ui_runStep()
 	UI_STEP_END(UI_STEP_NONE);
 }
 
-// derive the key described by ctx->pathSpec and run the ui state machine accordingly
+// run the ui state machine for the key described by ctx->pathSpec, the key is derived at its end
 static void runGetOnePublicKeyUIFlow()
 {
 	ASSERT(ctx->ui_step == UI_STEP_NONE); // make sure no ui state machine is running
@@ -119,14 +126,7 @@ static void runGetOnePublicKeyUIFlow()
 	TRACE("Policy: %d", (int) policy);
 	ENSURE_NOT_DENIED(policy);
 
-	{
-		// Calculation
-		deriveExtendedPublicKey(
-		        & ctx->pathSpec,
-		        & ctx->extPubKey
-		);
-		ctx->responseReadyMagic = RESPONSE_READY_MAGIC;
-	}
+	ctx->responseReadyMagic = RESPONSE_READY_MAGIC;
 
 	switch (policy) {
 #define  CASE(policy, step) case policy: {ctx->ui_step = step; break;}
@@ -189,10 +189,11 @@ static void getPublicKeys_handleInit_ui_runStep()
 	UI_STEP_END(UI_STEP_NONE);
 }
 
-static void getPublicKeys_handleInitAPDU(const uint8_t* wireDataBuffer, size_t wireDataSize)
+static void getPublicKeys_handleInitAPDU(uint8_t p2, const uint8_t* wireDataBuffer, size_t wireDataSize)
 {
 	{
 		CHECK_STAGE(GET_KEYS_STAGE_INIT);
+		VALIDATE(p2 == P2_UNUSED, ERR_INVALID_REQUEST_PARAMETERS);
 
 		ASSERT(wireDataSize < BUFFER_SIZE_PARANOIA);
 	}
@@ -257,19 +258,81 @@ static void getPublicKeys_handleInitAPDU(const uint8_t* wireDataBuffer, size_t w
 
 // ============================== GET KEY HANDLER ==============================
 
+enum {
+	P2_SINGLE_PATH = 0x00,
+	P2_MULTIPLE_PATHS = 0x01,
+};
+
+STATIC_ASSERT(
+        SIZEOF(instructionState.getKeysContext.extPubKeys) + 2 < SIZEOF(G_io_apdu_buffer),
+        "too many public keys per response"
+);
+
+// Several paths can be given in a single APDU.
+// Keys for the longest prefix of the paths allowed without a prompt
+// are returned together, the host is supposed to resend the remaining paths.
+// If the first path requires a prompt, it is processed as a single key.
+static void getPublicKeys_handleGetNextKeysMultiple(read_view_t* view)
+{
+	VALIDATE(view_remainingSize(view) > 0, ERR_INVALID_DATA);
+
+	size_t numKeys = 0;
+	while (view_remainingSize(view) > 0 && numKeys < ARRAY_LEN(ctx->extPubKeys)) {
+		VALIDATE(ctx->currentPath + numKeys < ctx->numPaths, ERR_INVALID_DATA);
+
+		parsePath(view);
+
+		security_policy_t policy = policyForGetExtendedPublicKeyBulkExport(&ctx->pathSpec);
+		TRACE("Policy: %d", (int) policy);
+		ENSURE_NOT_DENIED(policy);
+
+		if (policy != POLICY_ALLOW_WITHOUT_PROMPT) {
+			if (numKeys == 0) {
+				// the usual flow with a prompt
+				runGetOnePublicKeyUIFlow();
+				return;
+			}
+			// the remaining paths are to be resent
+			break;
+		}
+
+		derivationCache_deriveExtendedPublicKey(&ctx->pathSpec, &ctx->extPubKeys[numKeys]);
+		numKeys++;
+	}
+
+	TRACE("Sending %u public keys", (unsigned) numKeys);
+	ASSERT(numKeys > 0);
+	io_send_buf(SUCCESS, (uint8_t*) ctx->extPubKeys, numKeys * SIZEOF(ctx->extPubKeys[0]));
+	ui_displayBusy(); // displays dots, called only after I/O to avoid freezing
+
+	ctx->currentPath += numKeys;
+	TRACE("Current path: %u / %u", ctx->currentPath, ctx->numPaths);
+
+	if (ctx->currentPath == ctx->numPaths)
+		advanceStage();
+}
 
 void getPublicKeys_handleGetNextKeyAPDU(
+        uint8_t p2,
         const uint8_t* wireDataBuffer,
         size_t wireDataSize
 )
 {
 	CHECK_STAGE(GET_KEYS_STAGE_GET_KEYS);
+	VALIDATE(p2 == P2_SINGLE_PATH || p2 == P2_MULTIPLE_PATHS, ERR_INVALID_REQUEST_PARAMETERS);
 
 	ASSERT(wireDataSize < BUFFER_SIZE_PARANOIA);
 
 	VALIDATE(ctx->currentPath < ctx->numPaths, ERR_INVALID_STATE);
+	ASSERT(ctx->ui_step == UI_STEP_NONE); // make sure no ui state machine is running
 
 	read_view_t view = make_read_view(wireDataBuffer, wireDataBuffer + wireDataSize);
+
+	if (p2 == P2_MULTIPLE_PATHS) {
+		getPublicKeys_handleGetNextKeysMultiple(&view);
+		return;
+	}
+
 	parsePath(&view);
 	VALIDATE(view_remainingSize(&view) == 0, ERR_INVALID_DATA);
 
@@ -278,7 +341,7 @@ void getPublicKeys_handleGetNextKeyAPDU(
 
 // ============================== MAIN HANDLER ==============================
 
-typedef void subhandler_fn_t(const uint8_t* dataBuffer, size_t dataSize);
+typedef void subhandler_fn_t(uint8_t p2, const uint8_t* dataBuffer, size_t dataSize);
 
 static subhandler_fn_t* lookup_subhandler(uint8_t p1)
 {
@@ -308,9 +371,8 @@ void getPublicKeys_handleAPDU(
 		ctx->stage = GET_KEYS_STAGE_INIT;
 		ctx->ui_step = UI_STEP_NONE;
 	}
-	VALIDATE(p2 == P2_UNUSED, ERR_INVALID_REQUEST_PARAMETERS);
 
 	subhandler_fn_t* subhandler = lookup_subhandler(p1);
 	VALIDATE(subhandler != NULL, ERR_INVALID_REQUEST_PARAMETERS);
-	subhandler(wireDataBuffer, wireDataSize);
+	subhandler(p2, wireDataBuffer, wireDataSize);
 }
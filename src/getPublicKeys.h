@@ -8,6 +8,9 @@
 
 #define MAX_PUBLIC_KEYS 1000
 
+// in bulk export, up to this many keys can be returned in a single response
+#define MAX_PUBLIC_KEYS_PER_RESPONSE 3
+
 typedef enum {
 	GET_KEYS_STAGE_NONE = 0,
 	GET_KEYS_STAGE_INIT = 20,
@@ -21,7 +24,8 @@ typedef struct {
 	uint16_t numPaths;
 
 	bip44_path_t pathSpec;
-	extendedPublicKey_t extPubKey;
+	// bulk export only, a single key is derived directly into the response
+	extendedPublicKey_t extPubKeys[MAX_PUBLIC_KEYS_PER_RESPONSE];
 
 	uint16_t responseReadyMagic;
 
@@ -3,6 +3,7 @@
 
 #include "getSerial.h"
 #include "uiHelpers.h"
+#include "bufView.h"
 
 // required by os_serial
 #define SERIAL_LENGTH 7
@@ -23,10 +24,12 @@ void getSerial_handleAPDU(
 	STATIC_ASSERT(sizeof(uint8_t) == sizeof(unsigned char), "bad unsigned char size");
 	STATIC_ASSERT(sizeof(size_t) >= sizeof(unsigned int), "bad unsigned int size");
 
-	uint8_t response[SERIAL_LENGTH] = {0};
-	size_t len = os_serial(response, SERIAL_LENGTH);
+	write_view_t response = make_response_view();
+	ASSERT(view_remainingSize(&response) >= SERIAL_LENGTH);
+	size_t len = os_serial(response.ptr, SERIAL_LENGTH);
 	ASSERT(len == SERIAL_LENGTH);
+	view_skipBytes(&response, SERIAL_LENGTH);
 
-	io_send_buf(SUCCESS, response, SERIAL_LENGTH);
+	view_sendResponse(SUCCESS, &response);
 	ui_idle();
 }
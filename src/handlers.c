@@ -11,6 +11,7 @@
 #include "errors.h"
 #include "deriveAddress.h"
 #include "deriveNativeScriptHash.h"
+#include "checkOwnership.h"
 #include "signTx.h"
 #include "signOpCert.h"
 #include "signCVote.h"
@@ -30,6 +31,7 @@ handler_fn_t* lookupHandler(uint8_t ins)
 		CASE(0x10, getPublicKeys_handleAPDU);
 		CASE(0x11, deriveAddress_handleAPDU);
 		CASE(0x12, deriveNativeScriptHash_handleAPDU);
+		CASE(0x13, checkOwnership_handleAPDU);
 
 		// 0x2* -  signing related
 		CASE(0x21, signTx_handleAPDU);
@@ -47,4 +49,27 @@ handler_fn_t* lookupHandler(uint8_t ins)
 	}
 }
 
+bool isResumeRequest(uint8_t ins, uint8_t p1, uint8_t p2)
+{
+	switch (ins) {
+	case 0x21:
+		return signTx_isResumeRequest(p1, p2);
+
+	default:
+		return false;
+	}
+}
+
+void wipeInstructionSecrets(int ins)
+{
+	switch (ins) {
+	case 0x21:
+		signTx_wipeSecrets();
+		break;
+
+	default:
+		break;
+	}
+}
+
 #endif
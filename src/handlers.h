@@ -13,4 +13,11 @@ typedef void handler_fn_t(
 
 handler_fn_t* lookupHandler(uint8_t ins);
 
+// whether the request continues an instruction interrupted by a transport reset
+bool isResumeRequest(uint8_t ins, uint8_t p1, uint8_t p2);
+
+// wipes private keys an instruction keeps across APDUs,
+// called whenever the instruction ends (normally, with an error or by a transport reset)
+void wipeInstructionSecrets(int ins);
+
 #endif // H_CARDANO_APP_HANDLERS
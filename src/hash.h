@@ -93,6 +93,70 @@ __CIPHER_DECLARE(BLAKE2B, blake2b, 512)
 __CIPHER_DECLARE(SHA3, sha3, 256)
 
 
+// Each append is a syscall (cx_hash) which costs much more than hashing a few bytes,
+// so hash builders (appending mostly CBOR tokens of 1--9 bytes) gather the data
+// in a staging buffer and pass it to the firmware only when the buffer is full.
+#if defined(TARGET_NANOS)
+#define HASH_STAGING_BUFFER_SIZE 64
+#else
+#define HASH_STAGING_BUFFER_SIZE 128 // blake2b block size
+#endif
+
+#define __BUFFERED_CIPHER_DECLARE(cipher, bits) \
+	typedef struct { \
+		cipher##_##bits##_context_t hashCtx; \
+		size_t stagedSize; \
+		uint8_t stagingBuffer[HASH_STAGING_BUFFER_SIZE]; \
+	} cipher##_##bits##_buffered_context_t;\
+	\
+	static __attribute__((always_inline, unused)) void cipher##_##bits##_buffered_init( \
+	        cipher##_##bits##_buffered_context_t* ctx \
+	                                                                                  ) \
+	{ \
+		cipher##_##bits##_init(&ctx->hashCtx); \
+		ctx->stagedSize = 0; \
+	} \
+	\
+	static __attribute__((always_inline, unused)) void cipher##_##bits##_buffered_flush( \
+	        cipher##_##bits##_buffered_context_t* ctx \
+	                                                                                   ) { \
+		ASSERT(ctx->stagedSize <= HASH_STAGING_BUFFER_SIZE); \
+		if (ctx->stagedSize > 0) { \
+			cipher##_##bits##_append(&ctx->hashCtx, ctx->stagingBuffer, ctx->stagedSize); \
+			ctx->stagedSize = 0; \
+		} \
+	} \
+	\
+	static __attribute__((always_inline, unused)) void cipher##_##bits##_buffered_append( \
+	        cipher##_##bits##_buffered_context_t* ctx, \
+	        const uint8_t* inBuffer, size_t inSize \
+	                                                                                    ) { \
+		ASSERT(inSize < BUFFER_SIZE_PARANOIA); \
+		ASSERT(ctx->stagedSize <= HASH_STAGING_BUFFER_SIZE); \
+		if (inSize > HASH_STAGING_BUFFER_SIZE - ctx->stagedSize) { \
+			cipher##_##bits##_buffered_flush(ctx); \
+			if (inSize >= HASH_STAGING_BUFFER_SIZE) { \
+				/* nothing to gain from copying it */ \
+				cipher##_##bits##_append(&ctx->hashCtx, inBuffer, inSize); \
+				return; \
+			} \
+		} \
+		memmove(ctx->stagingBuffer + ctx->stagedSize, inBuffer, inSize); \
+		ctx->stagedSize += inSize; \
+	} \
+	\
+	static __attribute__((always_inline, unused)) void cipher##_##bits##_buffered_finalize( \
+	        cipher##_##bits##_buffered_context_t* ctx, \
+	        uint8_t* outBuffer, size_t outSize \
+	                                                                                      ) { \
+		cipher##_##bits##_buffered_flush(ctx); \
+		cipher##_##bits##_finalize(&ctx->hashCtx, outBuffer, outSize); \
+	}
+
+__BUFFERED_CIPHER_DECLARE(blake2b, 224)
+__BUFFERED_CIPHER_DECLARE(blake2b, 256)
+
+
 #ifdef DEVEL
 void run_hash_test();
 #endif // DEVEL
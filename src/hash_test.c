@@ -118,9 +118,55 @@ void run_blake2b_test()
 	}
 }
 
+// the buffered context must not change the hash, however the data are chunked
+static void testcase_buffered_blake2b_256(const size_t* chunkSizes, size_t chunksCount)
+{
+	PRINTF("testcase_buffered_blake2b_256\n");
+	uint8_t inputBuffer[1000] = {0};
+	for (size_t i = 0; i < SIZEOF(inputBuffer); i++) {
+		inputBuffer[i] = (uint8_t) (i * 7 + 3);
+	}
+
+	blake2b_256_buffered_context_t ctx;
+	blake2b_256_buffered_init(&ctx);
+	size_t inputSize = 0;
+	for (size_t i = 0; i < chunksCount; i++) {
+		ASSERT(inputSize + chunkSizes[i] <= SIZEOF(inputBuffer));
+		blake2b_256_buffered_append(&ctx, inputBuffer + inputSize, chunkSizes[i]);
+		inputSize += chunkSizes[i];
+	}
+	uint8_t outputBuffer[32] = {0};
+	blake2b_256_buffered_finalize(&ctx, outputBuffer, SIZEOF(outputBuffer));
+
+	uint8_t expectedBuffer[32] = {0};
+	blake2b_256_hash(inputBuffer, inputSize, expectedBuffer, SIZEOF(expectedBuffer));
+
+	EXPECT_EQ_BYTES(expectedBuffer, outputBuffer, SIZEOF(expectedBuffer));
+}
+
+void run_buffered_blake2b_test()
+{
+#define TESTCASE_BUFFERED_BLAKE2B_256(chunkSizes_) \
+	{ \
+		const size_t chunkSizes[] = { UNWRAP chunkSizes_ }; \
+		testcase_buffered_blake2b_256(chunkSizes, ARRAY_LEN(chunkSizes)); \
+	}
+
+	TESTCASE_BUFFERED_BLAKE2B_256((0));
+	TESTCASE_BUFFERED_BLAKE2B_256((1, 2, 3, 9, 0, 1));
+	// exactly filling the staging buffer
+	TESTCASE_BUFFERED_BLAKE2B_256((HASH_STAGING_BUFFER_SIZE - 1, 1, HASH_STAGING_BUFFER_SIZE));
+	// overflowing it
+	TESTCASE_BUFFERED_BLAKE2B_256((3, HASH_STAGING_BUFFER_SIZE - 2, 5, 2 * HASH_STAGING_BUFFER_SIZE + 1, 9));
+	TESTCASE_BUFFERED_BLAKE2B_256((HASH_STAGING_BUFFER_SIZE + 1, 1, 1, 300));
+
+#undef TESTCASE_BUFFERED_BLAKE2B_256
+}
+
 void run_hash_test()
 {
 	run_blake2b_test();
+	run_buffered_blake2b_test();
 }
 
 #endif // DEVEL
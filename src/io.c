@@ -1,8 +1,17 @@
 #include "io.h"
 #include "common.h"
+#include "backgroundTasks.h"
 
 io_state_t io_state;
 
+static struct {
+	bool isActive;
+	// sub-commands are being processed, i.e. no UI step is pending
+	bool isRunning;
+	bool subcommandResponded;
+	uint8_t numProcessed;
+} batch;
+
 #if defined(TARGET_NANOS)
 static timeout_callback_fn_t* timeout_cb;
 
@@ -52,18 +61,104 @@ void _io_send_G_io_apdu_buffer(uint16_t code, uint16_t tx)
 	CHECK_RESPONSE_SIZE(tx);
 	G_io_apdu_buffer[tx++] = code >> 8;
 	G_io_apdu_buffer[tx++] = code & 0xFF;
+
+	// any response terminates a batch of sub-commands
+	io_batch_reset();
+
 	io_exchange(CHANNEL_APDU | IO_RETURN_AFTER_TX, tx);
 
 	// From now on we can receive new APDU
 	io_state = IO_EXPECT_IO;
 }
 
+uint8_t* io_responseBufferBegin()
+{
+	// the first byte is reserved for the number of sub-commands processed
+	return batch.isActive ? G_io_apdu_buffer + 1 : G_io_apdu_buffer;
+}
+
+uint8_t* io_responseBufferEnd()
+{
+	// the status word must fit after the data, see CHECK_RESPONSE_SIZE
+	return G_io_apdu_buffer + sizeof(G_io_apdu_buffer) - 3;
+}
+
+void io_send_responseBuffer(uint16_t code, const uint8_t* dataEnd)
+{
+	const uint8_t* dataBegin = io_responseBufferBegin();
+	ASSERT(dataBegin <= dataEnd);
+	ASSERT(dataEnd <= io_responseBufferEnd());
+	const size_t dataSize = (size_t) (dataEnd - dataBegin);
+
+	if (batch.isActive) {
+		if (code != SUCCESS) {
+			// errors are not prefixed
+			memmove(G_io_apdu_buffer, dataBegin, dataSize);
+			_io_send_G_io_apdu_buffer(code, dataSize);
+			return;
+		}
+		if (batch.isRunning && dataSize == 0) {
+			// the next sub-command will be processed
+			batch.subcommandResponded = true;
+			return;
+		}
+		G_io_apdu_buffer[0] = batch.numProcessed;
+	}
+
+	_io_send_G_io_apdu_buffer(code, (uint16_t) (dataEnd - G_io_apdu_buffer));
+}
+
 void io_send_buf(uint16_t code, uint8_t* buffer, size_t bufferSize)
 {
-	CHECK_RESPONSE_SIZE(bufferSize);
+	uint8_t* responseBuffer = io_responseBufferBegin();
+	ASSERT(bufferSize <= (size_t) (io_responseBufferEnd() - responseBuffer));
+
+	memmove(responseBuffer, buffer, bufferSize);
+	io_send_responseBuffer(code, responseBuffer + bufferSize);
+}
+
+void io_batch_reset()
+{
+	explicit_bzero(&batch, sizeof(batch));
+}
+
+void io_batch_begin()
+{
+	ASSERT(!batch.isActive);
 
-	memmove(G_io_apdu_buffer, buffer, bufferSize);
-	_io_send_G_io_apdu_buffer(code, bufferSize);
+	io_batch_reset();
+	batch.isActive = true;
+	batch.isRunning = true;
+}
+
+void io_batch_beginSubcommand()
+{
+	ASSERT(batch.isActive && batch.isRunning);
+	ASSERT(batch.numProcessed < UINT8_MAX);
+
+	batch.numProcessed++;
+	batch.subcommandResponded = false;
+}
+
+bool io_batch_canContinue()
+{
+	// a response with data has already been sent if the batch is not active
+	return batch.isActive && batch.isRunning && batch.subcommandResponded;
+}
+
+void io_batch_end()
+{
+	if (!batch.isActive) {
+		// the response has already been sent
+		return;
+	}
+	ASSERT(batch.isRunning);
+	batch.isRunning = false;
+
+	if (batch.subcommandResponded) {
+		io_send_buf(SUCCESS, NULL, 0);
+	}
+	// otherwise the response is sent after the UI step of the last sub-command
 }
 
 
@@ -102,13 +197,17 @@ unsigned char io_event(unsigned char channel MARK_UNUSED)
 		break;
 
 	case SEPROXYHAL_TAG_DISPLAY_PROCESSED_EVENT:
-		UX_DISPLAYED_EVENT({});
+		UX_DISPLAYED_EVENT({
+			// the screen is complete, the user is reading it
+			backgroundTasks_runSlice();
+		});
 		break;
 
 	case SEPROXYHAL_TAG_TICKER_EVENT:
 		UX_TICKER_EVENT(G_io_seproxyhal_spi_buffer, {
 			TRACE("timer");
 			HANDLE_UX_TICKER_EVENT(UX_ALLOWED);
+			backgroundTasks_runSlice();
 		});
 		break;
 
@@ -26,9 +26,32 @@ void _io_send_G_io_apdu_buffer(uint16_t code, uint16_t tx);
 // Normal code should use just this helper function
 void io_send_buf(uint16_t code, uint8_t* buffer, size_t bufferSize);
 
+// Zero-copy responses: the response data can be serialized directly
+// into [io_responseBufferBegin(), io_responseBufferEnd()) and sent by
+// io_send_responseBuffer (see also make_response_view in bufView.h).
+// This overwrites the incoming APDU data, so they must have been parsed
+// completely before, and no UI step can come in between.
+uint8_t* io_responseBufferBegin();
+uint8_t* io_responseBufferEnd();
+void io_send_responseBuffer(uint16_t code, const uint8_t* dataEnd);
+
 // Asserts that the response fits into response buffer
 void CHECK_RESPONSE_SIZE(unsigned int tx);
 
+// Support for multi-command APDUs (several sub-commands packed into one APDU).
+// While a batch is running, empty success responses of sub-commands
+// are not sent but only recorded. The first response that is actually sent
+// (with data, from a UI callback or after the last sub-command)
+// is prefixed by the number of sub-commands processed.
+void io_batch_reset();
+void io_batch_begin();
+void io_batch_beginSubcommand();
+// true if the current sub-command has finished with an empty success response
+// and the next sub-command can be processed
+bool io_batch_canContinue();
+// sends the response unless it is left to a pending UI step
+void io_batch_end();
+
 // This was added for sanity checking -- our program should always be awaiting on something
 // and it should be exactly the expected handler
 typedef enum {
@@ -0,0 +1,119 @@
+#include "lzDecompressor.h"
+#include "bufView.h"
+
+enum {
+	LZ_MATCH_FLAG = 0x80,
+};
+
+void lz_init(lz_decompressor_t* decompressor)
+{
+	explicit_bzero(decompressor, SIZEOF(*decompressor));
+	decompressor->state = LZ_STATE_TOKEN;
+}
+
+bool lz_isAtItemBoundary(const lz_decompressor_t* decompressor)
+{
+	return decompressor->state == LZ_STATE_TOKEN;
+}
+
+// outputs the part of the window not output so far
+static void _flush(lz_decompressor_t* decompressor, lz_output_fn_t* outputFn)
+{
+	ASSERT(decompressor->flushedPos <= decompressor->windowPos);
+
+	if (decompressor->windowPos > decompressor->flushedPos) {
+		outputFn(
+		        decompressor->window + decompressor->flushedPos,
+		        decompressor->windowPos - decompressor->flushedPos
+		);
+	}
+	decompressor->flushedPos = decompressor->windowPos;
+}
+
+static void _emitByte(
+        lz_decompressor_t* decompressor,
+        uint8_t byte,
+        size_t outputSizeLimit,
+        lz_output_fn_t* outputFn
+)
+{
+	VALIDATE(decompressor->outputSize < outputSizeLimit, ERR_INVALID_DATA);
+
+	ASSERT(decompressor->windowPos < LZ_WINDOW_SIZE);
+	decompressor->window[decompressor->windowPos] = byte;
+	decompressor->windowPos++;
+	decompressor->outputSize++;
+
+	if (decompressor->windowPos == LZ_WINDOW_SIZE) {
+		// the window must be output before it is overwritten
+		_flush(decompressor, outputFn);
+		decompressor->windowPos = 0;
+		decompressor->flushedPos = 0;
+	}
+}
+
+size_t lz_decompressChunk(
+        lz_decompressor_t* decompressor,
+        const uint8_t* buffer, size_t bufferSize,
+        size_t maxOutputSize,
+        lz_output_fn_t* outputFn
+)
+{
+	ASSERT(bufferSize < BUFFER_SIZE_PARANOIA);
+	ASSERT(maxOutputSize <= SIZE_MAX - decompressor->outputSize);
+
+	const size_t initialOutputSize = decompressor->outputSize;
+	const size_t outputSizeLimit = initialOutputSize + maxOutputSize;
+
+	read_view_t view = make_read_view(buffer, buffer + bufferSize);
+	while (view_remainingSize(&view) > 0) {
+		switch (decompressor->state) {
+
+		case LZ_STATE_TOKEN: {
+			const uint8_t token = parse_u1be(&view);
+			if (token & LZ_MATCH_FLAG) {
+				STATIC_ASSERT(0x7F + LZ_MIN_MATCH_LENGTH <= UINT8_MAX, "match length overflow");
+				decompressor->pendingLength = (uint8_t) ((token & ~LZ_MATCH_FLAG) + LZ_MIN_MATCH_LENGTH);
+				decompressor->state = LZ_STATE_MATCH_DISTANCE;
+			} else {
+				decompressor->pendingLength = (uint8_t) (token + 1);
+				decompressor->state = LZ_STATE_LITERALS;
+			}
+			break;
+		}
+
+		case LZ_STATE_LITERALS: {
+			_emitByte(decompressor, parse_u1be(&view), outputSizeLimit, outputFn);
+
+			ASSERT(decompressor->pendingLength > 0);
+			decompressor->pendingLength--;
+			if (decompressor->pendingLength == 0) {
+				decompressor->state = LZ_STATE_TOKEN;
+			}
+			break;
+		}
+
+		case LZ_STATE_MATCH_DISTANCE: {
+			STATIC_ASSERT(UINT8_MAX + 1 <= LZ_WINDOW_SIZE, "distance does not fit the window");
+			const size_t distance = (size_t) parse_u1be(&view) + 1;
+			VALIDATE(distance <= decompressor->outputSize, ERR_INVALID_DATA);
+
+			while (decompressor->pendingLength > 0) {
+				// the source is at most LZ_WINDOW_SIZE bytes back, so it has not been overwritten
+				const size_t sourcePos = (decompressor->windowPos + LZ_WINDOW_SIZE - distance) % LZ_WINDOW_SIZE;
+				_emitByte(decompressor, decompressor->window[sourcePos], outputSizeLimit, outputFn);
+				decompressor->pendingLength--;
+			}
+			decompressor->state = LZ_STATE_TOKEN;
+			break;
+		}
+
+		default:
+			ASSERT(false);
+		}
+	}
+
+	_flush(decompressor, outputFn);
+
+	return decompressor->outputSize - initialOutputSize;
+}
@@ -0,0 +1,60 @@
+#ifndef H_CARDANO_APP_LZ_DECOMPRESSOR
+#define H_CARDANO_APP_LZ_DECOMPRESSOR
+
+#include "common.h"
+
+// A simple LZ77-style streaming decompressor with a bounded window.
+//
+// The compressed stream is a sequence of items, each starting with a token byte t:
+// - t < 0x80: literal run, (t + 1) bytes follow and are copied to the output;
+// - t >= 0x80: match of length (t - 0x80 + LZ_MIN_MATCH_LENGTH), followed by
+//   one byte d; the bytes are copied from distance (d + 1) back in the output
+//   (the source may overlap with the bytes being produced).
+//
+// Items may be split arbitrarily between chunks of the compressed stream.
+
+#define LZ_WINDOW_SIZE 256
+#define LZ_MIN_MATCH_LENGTH 3
+
+typedef enum {
+	LZ_STATE_TOKEN = 1,
+	LZ_STATE_LITERALS = 2,
+	LZ_STATE_MATCH_DISTANCE = 3,
+} lz_decompressor_state_t;
+
+// receives the decompressed data
+typedef void lz_output_fn_t(const uint8_t* buffer, size_t bufferSize);
+
+typedef struct {
+	lz_decompressor_state_t state;
+	// remaining literals or length of the match
+	uint8_t pendingLength;
+	uint16_t windowPos;
+	// the part of the window before this position has been output
+	uint16_t flushedPos;
+	// total size of the decompressed data so far
+	size_t outputSize;
+	uint8_t window[LZ_WINDOW_SIZE];
+} lz_decompressor_t;
+
+void lz_init(lz_decompressor_t* decompressor);
+
+// Decompresses one chunk of the compressed stream, passing the output to outputFn
+// (possibly in several pieces). Throws ERR_INVALID_DATA if more than maxOutputSize
+// bytes would be produced. Returns the size of the decompressed data.
+size_t lz_decompressChunk(
+        lz_decompressor_t* decompressor,
+        const uint8_t* buffer, size_t bufferSize,
+        size_t maxOutputSize,
+        lz_output_fn_t* outputFn
+);
+
+// true if the compressed stream can end here (no item is incomplete)
+bool lz_isAtItemBoundary(const lz_decompressor_t* decompressor);
+
+
+#ifdef DEVEL
+void run_lzDecompressor_test();
+#endif // DEVEL
+
+#endif // H_CARDANO_APP_LZ_DECOMPRESSOR
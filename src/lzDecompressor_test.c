@@ -0,0 +1,127 @@
+#ifdef DEVEL
+
+#include "lzDecompressor.h"
+#include "hexUtils.h"
+#include "testUtils.h"
+
+static uint8_t output[500];
+static size_t outputSize;
+
+static void collectOutput(const uint8_t* buffer, size_t bufferSize)
+{
+	ASSERT(outputSize + bufferSize <= SIZEOF(output));
+	memmove(output + outputSize, buffer, bufferSize);
+	outputSize += bufferSize;
+}
+
+// decompresses the input split into two chunks at every possible position
+static void testDecompression(const uint8_t* input, size_t inputSize, const uint8_t* expected, size_t expectedSize)
+{
+	for (size_t split = 0; split <= inputSize; split++) {
+		lz_decompressor_t decompressor;
+		lz_init(&decompressor);
+		explicit_bzero(output, SIZEOF(output));
+		outputSize = 0;
+
+		size_t size1 = lz_decompressChunk(&decompressor, input, split, expectedSize, collectOutput);
+		size_t size2 = lz_decompressChunk(&decompressor, input + split, inputSize - split, expectedSize - size1, collectOutput);
+
+		EXPECT_EQ(size1 + size2, expectedSize);
+		EXPECT_EQ(outputSize, expectedSize);
+		EXPECT_EQ_BYTES(output, expected, expectedSize);
+		EXPECT_EQ(lz_isAtItemBoundary(&decompressor), true);
+	}
+}
+
+static void testVectors()
+{
+	const struct {
+		const char* compressedHex;
+		const char* expectedHex;
+	} testVectors[] = {
+		// literals only
+		{"0361626364", "61626364"},
+		// match overlapping with its own output
+		{"00618100", "6161616161"},
+		{"026162638302", "616263616263616263"},
+		// literals after a match
+		{"026162638002017879", "6162636162637879"},
+	};
+
+	ITERATE(it, testVectors) {
+		PRINTF("testcase_lzDecompressor %s\n", PTR_PIC(it->compressedHex));
+		uint8_t compressed[50] = {0};
+		size_t compressedSize = decode_hex(PTR_PIC(it->compressedHex), compressed, SIZEOF(compressed));
+		uint8_t expected[50] = {0};
+		size_t expectedSize = decode_hex(PTR_PIC(it->expectedHex), expected, SIZEOF(expected));
+
+		testDecompression(compressed, compressedSize, expected, expectedSize);
+	}
+}
+
+static void testWindowWrap()
+{
+	PRINTF("testcase_lzDecompressor window wrap\n");
+	// 256 literals in two runs, then a match of maximal length from maximal distance
+	uint8_t compressed[2 * (1 + 128) + 2] = {0};
+	uint8_t expected[256 + 130] = {0};
+	size_t pos = 0;
+	for (size_t run = 0; run < 2; run++) {
+		compressed[pos++] = 0x7F;
+		for (size_t i = 0; i < 128; i++) {
+			compressed[pos++] = (uint8_t) (run * 128 + i);
+		}
+	}
+	compressed[pos++] = 0xFF;
+	compressed[pos++] = 0xFF;
+	ASSERT(pos == SIZEOF(compressed));
+
+	for (size_t i = 0; i < SIZEOF(expected); i++) {
+		expected[i] = (uint8_t) (i % 256);
+	}
+
+	testDecompression(compressed, SIZEOF(compressed), expected, SIZEOF(expected));
+}
+
+static void testInvalid()
+{
+	PRINTF("testcase_lzDecompressor invalid\n");
+	lz_decompressor_t decompressor;
+
+	{
+		// match reaching before the start of the output
+		const uint8_t compressed[] = {0x01, 0x61, 0x62, 0x80, 0x02};
+		lz_init(&decompressor);
+		EXPECT_THROWS(
+		        lz_decompressChunk(&decompressor, compressed, SIZEOF(compressed), 100, collectOutput),
+		        ERR_INVALID_DATA
+		);
+	}
+	{
+		// more output than declared
+		const uint8_t compressed[] = {0x03, 0x61, 0x62, 0x63, 0x64};
+		lz_init(&decompressor);
+		outputSize = 0;
+		EXPECT_THROWS(
+		        lz_decompressChunk(&decompressor, compressed, SIZEOF(compressed), 3, collectOutput),
+		        ERR_INVALID_DATA
+		);
+	}
+	{
+		// incomplete item
+		const uint8_t compressed[] = {0x03, 0x61, 0x62};
+		lz_init(&decompressor);
+		outputSize = 0;
+		lz_decompressChunk(&decompressor, compressed, SIZEOF(compressed), 100, collectOutput);
+		EXPECT_EQ(lz_isAtItemBoundary(&decompressor), false);
+	}
+}
+
+void run_lzDecompressor_test()
+{
+	testVectors();
+	testWindowWrap();
+	testInvalid();
+}
+
+#endif // DEVEL
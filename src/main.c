@@ -32,6 +32,9 @@
 #include "menu.h"
 #include "assert.h"
 #include "io.h"
+#include "derivationCache.h"
+#include "backgroundTasks.h"
+#include "xpubCache.h"
 
 // The whole app is designed for a specific api level.
 // In case there is an api change, first *verify* changes
@@ -45,11 +48,15 @@ static const int INS_NONE = -1;
 // menu as its idle screen; you can define your own completely custom screen.
 void ui_idle(void)
 {
+	// the instruction is over (done, rejected or failed)
+	wipeInstructionSecrets(currentInstruction);
 	currentInstruction = INS_NONE;
+	backgroundTasks_reset();
 
 	#if defined(TARGET_NANOS)
 	nanos_clear_timer();
 	h_expert_update();
+	h_xpub_cache_update();
 	// The first argument is the starting index within menu_main, and the last
 	// argument is a preprocessor.
 	UX_MENU_DISPLAY(0, menu_main, NULL);
@@ -97,16 +104,17 @@ static void cardano_main(void)
 				rx = (unsigned int) io_exchange((uint8_t) (CHANNEL_APDU | flags), (uint16_t) rx);
 				flags = 0;
 
-				// We should be awaiting APDU
-				ASSERT(io_state == IO_EXPECT_IO);
-				io_state = IO_EXPECT_NONE;
-
 				// No APDU received; trigger a reset.
+				// Note: io_state is kept, it tells whether the instruction can be resumed
 				if (rx == 0)
 				{
 					THROW(EXCEPTION_IO_RESET);
 				}
 
+				// We should be awaiting APDU
+				ASSERT(io_state == IO_EXPECT_IO);
+				io_state = IO_EXPECT_NONE;
+
 				VALIDATE(device_is_unlocked(), ERR_DEVICE_LOCKED);
 
 				// Note(ppershing): unsafe to access before checks
@@ -139,7 +147,15 @@ static void cardano_main(void)
 				bool isNewCall = false;
 				if (currentInstruction == INS_NONE)
 				{
-					explicit_bzero(&instructionState, SIZEOF(instructionState));
+					const bool isResume = (header->ins == interruptedInstruction)
+					                      && isResumeRequest(header->ins, header->p1, header->p2);
+					interruptedInstruction = INS_NONE;
+					backgroundTasks_reset();
+					if (!isResume) {
+						explicit_bzero(&instructionState, SIZEOF(instructionState));
+						derivationCache_reset();
+					}
+					// the handler validates the resumed state
 					isNewCall = true;
 					currentInstruction = header->ins;
 				} else
@@ -148,6 +164,9 @@ static void cardano_main(void)
 				}
 
 
+				// not done by background slices, see xpubCache_store
+				xpubCache_storePending();
+
 				// Note: handlerFn is responsible for calling io_send
 				// either during its call or subsequent UI actions
 				handlerFn(header->p1,
@@ -163,6 +182,7 @@ static void cardano_main(void)
 			}
 			CATCH(ERR_ASSERT)
 			{
+				wipeInstructionSecrets(currentInstruction);
 				// Note(ppershing): assertions should not auto-respond
 				#ifdef RESET_ON_CRASH
 				// Reset device
@@ -215,6 +235,10 @@ __attribute__((section(".boot"))) int main(void)
 	// exit critical section
 	__asm volatile("cpsie i");
 
+	// 0 is a valid instruction, so do not rely on zero-initialization
+	// (only set once, the value assigned on a reset must survive the loop below)
+	interruptedInstruction = INS_NONE;
+
 	for (;;) {
 		UX_INIT();
 		os_boot();
@@ -237,10 +261,18 @@ __attribute__((section(".boot"))) int main(void)
 				#endif
 
 				io_state = IO_EXPECT_IO;
+				// a batch interrupted by a reset must not affect further responses
+				io_batch_reset();
 				cardano_main();
 			}
 			CATCH(EXCEPTION_IO_RESET)
 			{
+				// the state of an instruction waiting for the next APDU
+				// (i.e. not in the middle of processing or of a UI step) stays consistent
+				interruptedInstruction = (io_state == IO_EXPECT_IO) ? currentInstruction : INS_NONE;
+				// even a resumable instruction must not keep private keys over the reset
+				wipeInstructionSecrets(currentInstruction);
+
 				// reset IO and UX before continuing
 				continue;
 			}
@@ -5,8 +5,9 @@
 #include <ux.h>
 
 #if defined(TARGET_NANOS)
-extern const ux_menu_entry_t menu_main[5];
+extern const ux_menu_entry_t menu_main[6];
 void h_expert_update();
+void h_xpub_cache_update();
 #elif defined(TARGET_NANOX) || defined(TARGET_NANOS2)
 extern const ux_flow_step_t* const ux_idle_flow [];
 #endif
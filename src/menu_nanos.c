@@ -8,6 +8,7 @@
 #include "glyphs.h"
 #include "utils.h"
 #include "app_mode.h"
+#include "xpubCache.h"
 
 char expertModeString[9];
 
@@ -26,6 +27,23 @@ void h_expert_update()
 	}
 }
 
+char xpubCacheString[9];
+
+static void h_xpub_cache_toggle()
+{
+	xpubCache_setEnabled(!xpubCache_isEnabled());
+	h_xpub_cache_update();
+	UX_MENU_DISPLAY(2, menu_main, NULL);
+}
+
+void h_xpub_cache_update()
+{
+	snprintf(xpubCacheString, SIZEOF(xpubCacheString), "disabled");
+	if (xpubCache_isEnabled()) {
+		snprintf(xpubCacheString, SIZEOF(xpubCacheString), "enabled");
+	}
+}
+
 // Here we define the main menu, using the Ledger-provided menu API. This menu
 // turns out to be fairly unimportant for Nano S apps, since commands are sent
 // by the computer instead of being initiated by the user. It typically just
@@ -73,6 +91,7 @@ const ux_menu_entry_t menu_main[] = {
 	{NULL, NULL, 0, &C_icon_app, "Cardano", "is ready", 0, 0},
 	#endif
 	{NULL, h_expert_toggle, 0, NULL, "Expert mode:", expertModeString, 33, 12},
+	{NULL, h_xpub_cache_toggle, 0, NULL, "Key cache:", xpubCacheString, 33, 12},
 	{menu_about, NULL, 0, NULL, "About", NULL, 0, 0},
 	{NULL, os_sched_exit_ui_callback, 0, &C_icon_dashboard, "Quit app", NULL, 50, 29},
 	UX_MENU_END,
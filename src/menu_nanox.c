@@ -6,10 +6,14 @@
 #include "getVersion.h"
 #include "glyphs.h"
 #include "app_mode.h"
+#include "xpubCache.h"
 
 char expertModeString[9];
 static void h_expert_toggle();
 void h_expert_update();
+char xpubCacheString[9];
+static void h_xpub_cache_toggle();
+void h_xpub_cache_update();
 
 // Helper macro for better astyle formatting of UX_FLOW definitions
 #define LINES(...) { __VA_ARGS__ }
@@ -43,9 +47,20 @@ UX_STEP_CB_INIT(
         )
 );
 
-UX_STEP_NOCB(
+UX_STEP_CB_INIT(
         ux_idle_flow_3_step,
         bn,
+        h_xpub_cache_update(),
+        h_xpub_cache_toggle(),
+        LINES(
+                "Key cache:",
+                xpubCacheString
+        )
+);
+
+UX_STEP_NOCB(
+        ux_idle_flow_4_step,
+        bn,
         LINES(
                 "Version",
                 APPVERSION
@@ -53,7 +68,7 @@ UX_STEP_NOCB(
 );
 
 UX_STEP_CB(
-        ux_idle_flow_4_step,
+        ux_idle_flow_5_step,
         pb,
         os_sched_exit(-1),
         LINES(
@@ -67,7 +82,8 @@ UX_FLOW(
         &ux_idle_flow_1_step,
         &ux_idle_flow_2_step,
         &ux_idle_flow_3_step,
-        &ux_idle_flow_4_step
+        &ux_idle_flow_4_step,
+        &ux_idle_flow_5_step
 );
 
 static void h_expert_toggle()
@@ -84,4 +100,18 @@ void h_expert_update()
 	}
 }
 
+static void h_xpub_cache_toggle()
+{
+	xpubCache_setEnabled(!xpubCache_isEnabled());
+	ux_flow_init(0, ux_idle_flow, &ux_idle_flow_3_step);
+}
+
+void h_xpub_cache_update()
+{
+	snprintf(xpubCacheString, SIZEOF(xpubCacheString), "disabled");
+	if (xpubCache_isEnabled()) {
+		snprintf(xpubCacheString, SIZEOF(xpubCacheString), "enabled");
+	}
+}
+
 #endif
@@ -4,6 +4,8 @@
 #include "cardano.h"
 #include "keyDerivation.h"
 #include "bip44.h"
+#include "softDerivation.h"
+#include "securityPolicy.h"
 
 static void signRawMessage(privateKey_t* privateKey,
                            const uint8_t* messageBuffer, size_t messageSize,
@@ -64,6 +66,114 @@ static void signRawMessageWithPath(bip44_path_t* pathSpec,
 	} END_TRY;
 }
 
+static void _deriveNodePublicKey(const privateKey_t* privateKey, extendedPublicKey_t* extPubKey)
+{
+	cx_ecfp_public_key_t publicKey;
+	deriveRawPublicKey(privateKey, &publicKey);
+	extractRawPublicKey(&publicKey, extPubKey->pubKey, SIZEOF(extPubKey->pubKey));
+}
+
+static void _deriveAccountNode(signing_account_node_t* accountNode, const bip44_path_t* accountPath)
+{
+	chain_code_t chainCode;
+
+	TRACE("derive account node");
+
+	explicit_bzero(accountNode, SIZEOF(*accountNode));
+
+	BEGIN_TRY {
+		TRY {
+			derivePrivateKey(accountPath, &chainCode, &accountNode->accountKey);
+			_deriveNodePublicKey(&accountNode->accountKey, &accountNode->accountExtPubKey);
+
+			STATIC_ASSERT(SIZEOF(accountNode->accountExtPubKey.chainCode) == SIZEOF(chainCode.code), "bad chain code length");
+			memmove(accountNode->accountExtPubKey.chainCode, chainCode.code, SIZEOF(chainCode.code));
+
+			accountNode->accountPath = *accountPath;
+			accountNode->isAccountNodeValid = true;
+		}
+		FINALLY {
+			explicit_bzero(&chainCode, SIZEOF(chainCode));
+		}
+	} END_TRY;
+}
+
+static void _deriveChainNode(signing_account_node_t* accountNode, uint32_t chain)
+{
+	ASSERT(accountNode->isAccountNodeValid);
+
+	chain_code_t chainCode;
+
+	TRACE("derive chain node");
+
+	accountNode->isChainNodeValid = false;
+
+	BEGIN_TRY {
+		TRY {
+			softDerivation_deriveChildPrivateKey(
+			        &accountNode->accountKey, &accountNode->accountExtPubKey,
+			        chain,
+			        &accountNode->chainKey, &chainCode
+			);
+			_deriveNodePublicKey(&accountNode->chainKey, &accountNode->chainExtPubKey);
+
+			STATIC_ASSERT(SIZEOF(accountNode->chainExtPubKey.chainCode) == SIZEOF(chainCode.code), "bad chain code length");
+			memmove(accountNode->chainExtPubKey.chainCode, chainCode.code, SIZEOF(chainCode.code));
+
+			accountNode->chain = chain;
+			accountNode->isChainNodeValid = true;
+		}
+		FINALLY {
+			explicit_bzero(&chainCode, SIZEOF(chainCode));
+		}
+	} END_TRY;
+}
+
+static void signRawMessageWithAccountNode(signing_account_node_t* accountNode,
+        const bip44_path_t* pathSpec,
+        const uint8_t* messageBuffer, size_t messageSize,
+        uint8_t* outBuffer, size_t outSize)
+{
+	ASSERT(bip44_isDerivableFromAccount(pathSpec));
+	// the same check as in derivePrivateKey
+	ASSERT(policyForDerivePrivateKey(pathSpec) != POLICY_DENY);
+
+	bip44_path_t accountPath = *pathSpec;
+	accountPath.length = BIP44_I_CHAIN;
+
+	if (!accountNode->isAccountNodeValid || !bip44_pathsEqual(&accountNode->accountPath, &accountPath)) {
+		_deriveAccountNode(accountNode, &accountPath);
+	}
+	if (!accountNode->isChainNodeValid || accountNode->chain != pathSpec->path[BIP44_I_CHAIN]) {
+		_deriveChainNode(accountNode, pathSpec->path[BIP44_I_CHAIN]);
+	}
+
+	chain_code_t chainCode;
+	privateKey_t privateKey;
+
+	TRACE("derive private key from the chain node");
+
+	BEGIN_TRY {
+		TRY {
+			softDerivation_deriveChildPrivateKey(
+			        &accountNode->chainKey, &accountNode->chainExtPubKey,
+			        pathSpec->path[BIP44_I_ADDRESS],
+			        &privateKey, &chainCode
+			);
+
+			signRawMessage(
+			        &privateKey,
+			        messageBuffer, messageSize,
+			        outBuffer, outSize
+			);
+		}
+		FINALLY {
+			explicit_bzero(&privateKey, SIZEOF(privateKey));
+			explicit_bzero(&chainCode, SIZEOF(chainCode));
+		}
+	} END_TRY;
+}
+
 // sign the given hash by the private key derived according to the given path
 void getWitness(bip44_path_t* pathSpec,
                 const uint8_t* hashBuffer, size_t hashSize,
@@ -76,6 +186,26 @@ void getWitness(bip44_path_t* pathSpec,
 	#endif
 }
 
+void getWitnessWithAccountNode(signing_account_node_t* accountNode,
+                               bip44_path_t* pathSpec,
+                               const uint8_t* hashBuffer, size_t hashSize,
+                               uint8_t* outBuffer, size_t outSize)
+{
+	ASSERT(outSize < BUFFER_SIZE_PARANOIA);
+
+	#ifndef FUZZING
+	// the account node is not worth it for other paths (and might not be allowed)
+	bip44_path_t accountPath = *pathSpec;
+	accountPath.length = BIP44_I_CHAIN;
+	if (!bip44_isDerivableFromAccount(pathSpec) || policyForDerivePrivateKey(&accountPath) == POLICY_DENY) {
+		signRawMessageWithPath(pathSpec, hashBuffer, hashSize, outBuffer, outSize);
+		return;
+	}
+
+	signRawMessageWithAccountNode(accountNode, pathSpec, hashBuffer, hashSize, outBuffer, outSize);
+	#endif
+}
+
 void getCVoteRegistrationSignature(bip44_path_t* pathSpec,
                                    const uint8_t* payloadHashBuffer, size_t payloadHashSize,
                                    uint8_t* outBuffer, size_t outSize)
@@ -2,11 +2,34 @@
 #define H_CARDANO_APP_MESSAGE_SIGNING
 
 #include "bip44.h"
+#include "keyDerivation.h"
+
+// Private keys of an account node and of the last used chain node under it,
+// kept during a signing session so that witnesses for paths
+// m/purpose'/coin_type'/account'/chain/address do not need
+// a derivation from the seed each. Must be wiped by explicit_bzero when no longer needed.
+typedef struct {
+	bool isAccountNodeValid;
+	bip44_path_t accountPath;
+	privateKey_t accountKey;
+	extendedPublicKey_t accountExtPubKey;
+
+	bool isChainNodeValid;
+	uint32_t chain;
+	privateKey_t chainKey;
+	extendedPublicKey_t chainExtPubKey;
+} signing_account_node_t;
 
 void getWitness(bip44_path_t* pathSpec,
                 const uint8_t* txHashBuffer, size_t txHashSize,
                 uint8_t* outBuffer, size_t outSize);
 
+// the same as getWitness, but derives the key from the account node if possible
+void getWitnessWithAccountNode(signing_account_node_t* accountNode,
+                               bip44_path_t* pathSpec,
+                               const uint8_t* txHashBuffer, size_t txHashSize,
+                               uint8_t* outBuffer, size_t outSize);
+
 void getCVoteRegistrationSignature(bip44_path_t* pathSpec,
                                    const uint8_t* payloadHashBuffer, size_t payloadHashSize,
                                    uint8_t* outBuffer, size_t outSize);
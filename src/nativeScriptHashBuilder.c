@@ -15,24 +15,24 @@
 #define APPEND_BUFFER(buffer, size) blake2b_224_append_buffer_data(&builder->nativeScriptHash, buffer, size)
 
 static void blake2b_224_append_buffer_data(
-        blake2b_224_context_t* hashCtx,
+        blake2b_224_buffered_context_t* hashCtx,
         const uint8_t* buffer, size_t size
 )
 {
 	_TRACE_BUFFER(buffer, size);
-	blake2b_224_append(hashCtx, buffer, size);
+	blake2b_224_buffered_append(hashCtx, buffer, size);
 }
 
 __noinline_due_to_stack__
 static void blake2b_224_append_cbor_data(
-        blake2b_224_context_t* hashCtx,
+        blake2b_224_buffered_context_t* hashCtx,
         uint8_t type, uint64_t value
 )
 {
 	uint8_t buffer[10] = {0};
 	size_t size = cbor_writeToken(type, value, buffer, SIZEOF(buffer));
 	_TRACE_BUFFER(buffer, size);
-	blake2b_224_append(hashCtx, buffer, size);
+	blake2b_224_buffered_append(hashCtx, buffer, size);
 }
 
 static inline void advanceState(native_script_hash_builder_t* builder)
@@ -82,7 +82,7 @@ void nativeScriptHashBuilder_init(
 )
 {
 	TRACE("Serializing native script hash data");
-	blake2b_224_init(&builder->nativeScriptHash);
+	blake2b_224_buffered_init(&builder->nativeScriptHash);
 
 	// the native script hash is computed as a CBOR representation of the script,
 	// but with a zero byte prepended before the CBOR
@@ -220,7 +220,7 @@ void nativeScriptHashBuilder_finalize(
 
 	ASSERT(outSize == SCRIPT_HASH_LENGTH);
 
-	blake2b_224_finalize(&builder->nativeScriptHash, outBuffer, outSize);
+	blake2b_224_buffered_finalize(&builder->nativeScriptHash, outBuffer, outSize);
 }
 
 #undef APPEND_BUFFER
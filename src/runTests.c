@@ -6,9 +6,14 @@
 #include "bech32.h"
 #include "testUtils.h"
 #include "hexUtils.h"
+#include "bufView.h"
 #include "hash.h"
 #include "bip44.h"
 #include "keyDerivation.h"
+#include "derivationCache.h"
+#include "softDerivation.h"
+#include "xpubCache.h"
+#include "backgroundTasks.h"
 #include "addressUtilsByron.h"
 #include "addressUtilsShelley.h"
 #include "crc32.h"
@@ -19,6 +24,7 @@
 #include "uiHelpers.h"
 #include "tokens.h"
 #include "deriveNativeScriptHash.h"
+#include "lzDecompressor.h"
 
 
 void handleRunTests(
@@ -37,7 +43,9 @@ void handleRunTests(
 		run_base58_test();
 		run_bech32_test();
 		run_crc32_test();
+		run_lzDecompressor_test();
 		run_endian_test();
+		run_bufView_test();
 		run_textUtils_test();
 		run_tokens_test();
 		run_ipUtils_test();
@@ -45,6 +53,10 @@ void handleRunTests(
 		run_cbor_test();
 		run_bip44_test();
 		run_key_derivation_test();
+		run_softDerivation_test();
+		run_derivationCache_test();
+		run_xpubCache_test();
+		run_backgroundTasks_test();
 		run_addressUtilsByron_test();
 		run_addressUtilsShelley_test();
 		run_txHashBuilder_test();
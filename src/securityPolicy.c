@@ -272,6 +272,28 @@ security_policy_t policyForShowDeriveAddress(const addressParams_t* addressParam
 	return _policyForDeriveAddress(addressParams, POLICY_SHOW_BEFORE_RESPONSE);
 }
 
+// Check which addresses belong to the keys of the given accounts
+security_policy_t policyForCheckOwnershipInit(const bip44_path_t* lastAccountPath, const bip44_path_t* lastAddressPath)
+{
+	switch (bip44_classifyPath(lastAccountPath)) {
+
+	case PATH_ORDINARY_ACCOUNT:
+		break;
+
+	default:
+		DENY();
+		break;
+	}
+
+	DENY_UNLESS(bip44_classifyPath(lastAddressPath) == PATH_ORDINARY_SPENDING_KEY);
+	WARN_UNLESS(bip44_isPathReasonable(lastAddressPath));
+
+	// the host learns the same as from the account public keys, see policyForGetExtendedPublicKey
+	PROMPT_UNLESS(bip44_hasShelleyPrefix(lastAccountPath));
+	PROMPT_IF(app_mode_expert());
+	ALLOW();
+}
+
 // true iff network is the standard mainnet or testnet
 bool isNetworkUsual(uint32_t networkId, uint32_t protocolMagic)
 {
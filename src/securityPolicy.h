@@ -18,6 +18,8 @@ security_policy_t policyForGetExtendedPublicKeyBulkExport(const bip44_path_t* pa
 security_policy_t policyForShowDeriveAddress(const addressParams_t* addressParams);
 security_policy_t policyForReturnDeriveAddress(const addressParams_t* addressParams);
 
+security_policy_t policyForCheckOwnershipInit(const bip44_path_t* lastAccountPath, const bip44_path_t* lastAddressPath);
+
 bool isNetworkUsual(uint32_t networkId, uint32_t protocolMagic);
 bool isTxNetworkIdVerifiable(
         bool includeNetworkId,
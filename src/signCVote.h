@@ -32,7 +32,6 @@ typedef struct {
 			uint8_t proposalIndex;
 			uint8_t payloadTypeTag;
 		};
-		uint8_t votecastChunk[MAX_VOTECAST_CHUNK_SIZE];
 		struct {
 			bip44_path_t path;
 			uint8_t signature[ED25519_SIGNATURE_LENGTH];
@@ -30,6 +30,44 @@ enum {
 	UI_STEP_INVALID,
 };
 
+// the signature is computed only when responding and written directly into the response
+static void _signOpCert(uint8_t* outBuffer, size_t outSize)
+{
+	uint8_t opCertBodyBuffer[OP_CERT_BODY_LENGTH] = {0};
+	write_view_t opCertBodyBufferView = make_write_view(opCertBodyBuffer, opCertBodyBuffer + OP_CERT_BODY_LENGTH);
+
+	view_appendBuffer(&opCertBodyBufferView, (const uint8_t*) &ctx->kesPublicKey, SIZEOF(ctx->kesPublicKey));
+	{
+		uint8_t chunk[8] = {0};
+		u8be_write(chunk, ctx->issueCounter);
+		#ifdef FUZZING
+		view_appendBuffer(&opCertBodyBufferView, chunk, 8);
+		#else
+		view_appendBuffer(&opCertBodyBufferView, chunk, SIZEOF(chunk));
+		#endif
+	}
+	{
+		uint8_t chunk[8] = {0};
+		u8be_write(chunk, ctx->kesPeriod);
+		#ifdef FUZZING
+		view_appendBuffer(&opCertBodyBufferView, chunk, 8);
+		#else
+		view_appendBuffer(&opCertBodyBufferView, chunk, SIZEOF(chunk));
+		#endif
+	}
+
+	ASSERT(view_processedSize(&opCertBodyBufferView) == OP_CERT_BODY_LENGTH);
+	TRACE_BUFFER(opCertBodyBuffer, SIZEOF(opCertBodyBuffer));
+
+	getOpCertSignature(
+	        &ctx->poolColdKeyPathSpec,
+	        opCertBodyBuffer,
+	        OP_CERT_BODY_LENGTH,
+	        outBuffer,
+	        outSize
+	);
+}
+
 void signOpCert_handleAPDU(
         uint8_t p1,
         uint8_t p2,
@@ -74,41 +112,6 @@ void signOpCert_handleAPDU(
 	security_policy_t policy = policyForSignOpCert(&ctx->poolColdKeyPathSpec);
 	ENSURE_NOT_DENIED(policy);
 
-	{
-		uint8_t opCertBodyBuffer[OP_CERT_BODY_LENGTH] = {0};
-		write_view_t opCertBodyBufferView = make_write_view(opCertBodyBuffer, opCertBodyBuffer + OP_CERT_BODY_LENGTH);
-
-		view_appendBuffer(&opCertBodyBufferView, (const uint8_t*) &ctx->kesPublicKey, SIZEOF(ctx->kesPublicKey));
-		{
-			uint8_t chunk[8] = {0};
-			u8be_write(chunk, ctx->issueCounter);
-			#ifdef FUZZING
-			view_appendBuffer(&opCertBodyBufferView, chunk, 8);
-			#else
-			view_appendBuffer(&opCertBodyBufferView, chunk, SIZEOF(chunk));
-			#endif
-		}
-		{
-			uint8_t chunk[8] = {0};
-			u8be_write(chunk, ctx->kesPeriod);
-			#ifdef FUZZING
-			view_appendBuffer(&opCertBodyBufferView, chunk, 8);
-			#else
-			view_appendBuffer(&opCertBodyBufferView, chunk, SIZEOF(chunk));
-			#endif
-		}
-
-		ASSERT(view_processedSize(&opCertBodyBufferView) == OP_CERT_BODY_LENGTH);
-		TRACE_BUFFER(opCertBodyBuffer, SIZEOF(opCertBodyBuffer));
-
-		getOpCertSignature(
-		        &ctx->poolColdKeyPathSpec,
-		        opCertBodyBuffer,
-		        OP_CERT_BODY_LENGTH,
-		        ctx->signature,
-		        SIZEOF(ctx->signature)
-		);
-	}
 	ctx->responseReadyMagic = RESPONSE_READY_MAGIC;
 
 	switch (policy) {
@@ -197,7 +200,12 @@ static void signOpCert_ui_runStep()
 	UI_STEP(UI_STEP_RESPOND) {
 		ASSERT(ctx->responseReadyMagic == RESPONSE_READY_MAGIC);
 
-		io_send_buf(SUCCESS, (uint8_t*) &ctx->signature, SIZEOF(ctx->signature));
+		write_view_t response = make_response_view();
+		uint8_t* signature = response.ptr;
+		view_skipBytes(&response, ED25519_SIGNATURE_LENGTH);
+		_signOpCert(signature, ED25519_SIGNATURE_LENGTH);
+
+		view_sendResponse(SUCCESS, &response);
 		ui_idle();
 
 	}
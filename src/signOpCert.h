@@ -16,7 +16,6 @@ typedef struct {
 	uint64_t kesPeriod;
 	uint64_t issueCounter;
 	bip44_path_t poolColdKeyPathSpec;
-	uint8_t signature[64];
 	int ui_step;
 } ins_sign_op_cert_context_t;
 
@@ -287,6 +287,7 @@ static inline void advanceStage()
 	// intentional fallthrough
 
 	case SIGN_STAGE_WITNESSES:
+		explicit_bzero(&WITNESS_CTX->accountNode, SIZEOF(WITNESS_CTX->accountNode));
 		ctx->stage = SIGN_STAGE_NONE;
 		ui_idle(); // we are done with this tx
 		break;
@@ -657,6 +658,9 @@ static void signTx_handleInitAPDU(uint8_t p2, const uint8_t* wireDataBuffer, siz
 		// default values for variables whose value is not given in the APDU
 		ctx->poolOwnerByPath = false;
 		ctx->shouldDisplayTxid = false;
+
+		// only the host knowing the token can resume the session after a transport reset
+		cx_rng(ctx->sessionToken, SIZEOF(ctx->sessionToken));
 	}
 
 	security_policy_t policy = policyForSignTxInit(
@@ -920,6 +924,129 @@ static void ui_selectInputStep(security_policy_t policy)
 	}
 }
 
+// Inputs (and collateral and reference inputs) spending outputs of the same
+// transaction can be sent in a single APDU: the tx hash followed by a list of indices.
+enum {
+	P2_INPUT_GROUP = 0x01,
+};
+
+enum {
+	HANDLE_INPUT_GROUP_STEP_DISPLAY = 250,
+	HANDLE_INPUT_GROUP_STEP_NEXT,
+	HANDLE_INPUT_GROUP_STEP_RESPOND,
+	HANDLE_INPUT_GROUP_STEP_INVALID,
+};
+
+static void _selectGroupedInput()
+{
+	const sign_tx_input_group_t* group = &BODY_CTX->stageContext.input_group_subctx;
+	ASSERT(group->currentInput < group->numInputs);
+
+	BODY_CTX->stageData.input.input_data.index = group->indices[group->currentInput];
+	constructInputLabel(group->labelPrefix, group->firstInputNumber + group->currentInput);
+}
+
+static void signTx_handleInputGroup_ui_runStep()
+{
+	TRACE("UI step %d", ctx->ui_step);
+	ui_callback_fn_t* this_fn = signTx_handleInputGroup_ui_runStep;
+	sign_tx_input_group_t* group = &BODY_CTX->stageContext.input_group_subctx;
+
+	UI_STEP_BEGIN(ctx->ui_step, this_fn);
+
+	UI_STEP(HANDLE_INPUT_GROUP_STEP_DISPLAY) {
+		_selectGroupedInput();
+		ui_displayInputScreen(&BODY_CTX->stageData.input, this_fn);
+	}
+	UI_STEP(HANDLE_INPUT_GROUP_STEP_NEXT) {
+		ASSERT(group->currentInput < group->numInputs);
+		group->currentInput++;
+
+		if (group->currentInput < group->numInputs) {
+			UI_STEP_JUMP(HANDLE_INPUT_GROUP_STEP_DISPLAY);
+		}
+		UI_STEP_JUMP(HANDLE_INPUT_GROUP_STEP_RESPOND);
+	}
+	UI_STEP(HANDLE_INPUT_GROUP_STEP_RESPOND) {
+		respondSuccessEmptyMsg();
+
+		// the group context is overwritten when advancing to the next stage
+		const uint8_t numInputs = group->numInputs;
+		ASSERT(ctx->ui_advanceState != NULL);
+		for (uint8_t i = 0; i < numInputs; i++) {
+			ctx->ui_advanceState();
+		}
+	}
+	UI_STEP_END(HANDLE_INPUT_GROUP_STEP_INVALID);
+}
+
+typedef void add_input_fn_t(tx_hash_builder_t* builder, const tx_input_t* input);
+
+__noinline_due_to_stack__
+static void _handleInputGroup(
+        const uint8_t* wireDataBuffer, size_t wireDataSize,
+        uint16_t firstInputNumber, uint16_t numRemainingInputs,
+        const char* labelPrefix,
+        add_input_fn_t* addInputFn,
+        security_policy_t policy
+)
+{
+	TRACE("Policy: %d", (int) policy);
+	ENSURE_NOT_DENIED(policy);
+
+	sign_tx_input_group_t* group = &BODY_CTX->stageContext.input_group_subctx;
+	explicit_bzero(group, SIZEOF(*group));
+
+	tx_input_t* inputData = &BODY_CTX->stageData.input.input_data;
+	{
+		// parse data
+		TRACE_BUFFER(wireDataBuffer, wireDataSize);
+
+		typedef struct {
+			uint8_t index[4];
+		} wire_input_index_t;
+
+		read_view_t view = make_read_view(wireDataBuffer, wireDataBuffer + wireDataSize);
+		view_parseBuffer(inputData->txHashBuffer, &view, SIZEOF(inputData->txHashBuffer));
+
+		VALIDATE(view_remainingSize(&view) % sizeof(wire_input_index_t) == 0, ERR_INVALID_DATA);
+		const size_t numInputs = view_remainingSize(&view) / sizeof(wire_input_index_t);
+		TRACE("Number of inputs in group: %u", numInputs);
+		VALIDATE(numInputs > 0, ERR_INVALID_DATA);
+		VALIDATE(numInputs <= numRemainingInputs, ERR_INVALID_DATA);
+		VALIDATE(numInputs <= ARRAY_LEN(group->indices), ERR_INVALID_DATA);
+
+		group->labelPrefix = labelPrefix;
+		group->firstInputNumber = firstInputNumber;
+		group->numInputs = (uint8_t) numInputs;
+		const wire_input_index_t* wireIndices = view_parseRecords(&view, wire_input_index_t, numInputs);
+		for (size_t i = 0; i < numInputs; i++) {
+			group->indices[i] = u4be_read(wireIndices[i].index);
+		}
+		ASSERT(view_remainingSize(&view) == 0);
+	}
+	{
+		// add to tx
+		TRACE("Adding input group to tx hash");
+		for (size_t i = 0; i < group->numInputs; i++) {
+			inputData->index = group->indices[i];
+			addInputFn(&BODY_CTX->txHashBuilder, inputData);
+		}
+	}
+	{
+		// select UI steps
+		switch (policy) {
+#define  CASE(POLICY, UI_STEP) case POLICY: {ctx->ui_step=UI_STEP; break;}
+			CASE(POLICY_SHOW_BEFORE_RESPONSE, HANDLE_INPUT_GROUP_STEP_DISPLAY);
+			CASE(POLICY_ALLOW_WITHOUT_PROMPT, HANDLE_INPUT_GROUP_STEP_RESPOND);
+#undef   CASE
+		default:
+			THROW(ERR_NOT_IMPLEMENTED);
+		}
+	}
+	signTx_handleInputGroup_ui_runStep();
+}
+
 __noinline_due_to_stack__
 static void signTx_handleInputAPDU(uint8_t p2, const uint8_t* wireDataBuffer, size_t wireDataSize)
 {
@@ -929,10 +1056,22 @@ static void signTx_handleInputAPDU(uint8_t p2, const uint8_t* wireDataBuffer, si
 		CHECK_STAGE(SIGN_STAGE_BODY_INPUTS);
 		ASSERT(BODY_CTX->currentInput < ctx->numInputs);
 
-		VALIDATE(p2 == P2_UNUSED, ERR_INVALID_REQUEST_PARAMETERS);
+		VALIDATE(p2 == P2_UNUSED || p2 == P2_INPUT_GROUP, ERR_INVALID_REQUEST_PARAMETERS);
 		ASSERT(wireDataSize < BUFFER_SIZE_PARANOIA);
 	}
 
+	if (p2 == P2_INPUT_GROUP) {
+		ctx->ui_advanceState = ui_advanceState_input;
+		_handleInputGroup(
+		        wireDataBuffer, wireDataSize,
+		        BODY_CTX->currentInput, ctx->numInputs - BODY_CTX->currentInput,
+		        "Input",
+		        txHashBuilder_addInput,
+		        policyForSignTxInput(ctx->commonTxData.txSigningMode)
+		);
+		return;
+	}
+
 	parseInput(wireDataBuffer, wireDataSize);
 
 	security_policy_t policy = policyForSignTxInput(ctx->commonTxData.txSigningMode);
@@ -1951,10 +2090,22 @@ static void signTx_handleCollateralInputAPDU(uint8_t p2, const uint8_t* wireData
 		CHECK_STAGE(SIGN_STAGE_BODY_COLLATERAL_INPUTS);
 		ASSERT(BODY_CTX->currentCollateral < ctx->numCollateralInputs);
 
-		VALIDATE(p2 == P2_UNUSED, ERR_INVALID_REQUEST_PARAMETERS);
+		VALIDATE(p2 == P2_UNUSED || p2 == P2_INPUT_GROUP, ERR_INVALID_REQUEST_PARAMETERS);
 		ASSERT(wireDataSize < BUFFER_SIZE_PARANOIA);
 	}
 
+	if (p2 == P2_INPUT_GROUP) {
+		ctx->ui_advanceState = ui_advanceState_collateralInput;
+		_handleInputGroup(
+		        wireDataBuffer, wireDataSize,
+		        BODY_CTX->currentCollateral, ctx->numCollateralInputs - BODY_CTX->currentCollateral,
+		        "Collat. input",
+		        txHashBuilder_addCollateralInput,
+		        policyForSignTxCollateralInput(ctx->commonTxData.txSigningMode, ctx->includeTotalCollateral)
+		);
+		return;
+	}
+
 	parseInput(wireDataBuffer, wireDataSize);
 
 	security_policy_t policy = policyForSignTxCollateralInput(
@@ -2219,9 +2370,21 @@ static void signTx_handleReferenceInputsAPDU(uint8_t p2, const uint8_t* wireData
 		CHECK_STAGE(SIGN_STAGE_BODY_REFERENCE_INPUTS);
 		ASSERT(BODY_CTX->currentReferenceInput < ctx->numReferenceInputs);
 
-		VALIDATE(p2 == P2_UNUSED, ERR_INVALID_REQUEST_PARAMETERS);
+		VALIDATE(p2 == P2_UNUSED || p2 == P2_INPUT_GROUP, ERR_INVALID_REQUEST_PARAMETERS);
 		ASSERT(wireDataSize < BUFFER_SIZE_PARANOIA);
 	}
+
+	if (p2 == P2_INPUT_GROUP) {
+		ctx->ui_advanceState = ui_advanceState_ReferenceInput;
+		_handleInputGroup(
+		        wireDataBuffer, wireDataSize,
+		        BODY_CTX->currentReferenceInput, ctx->numReferenceInputs - BODY_CTX->currentReferenceInput,
+		        "Refer. input",
+		        txHashBuilder_addReferenceInput,
+		        policyForSignTxReferenceInput(ctx->commonTxData.txSigningMode)
+		);
+		return;
+	}
 	// Parsed in same way as the inputs
 	parseInput(wireDataBuffer, wireDataSize);
 
@@ -2356,10 +2519,10 @@ static void signTx_handleConfirmAPDU(uint8_t p2, const uint8_t* wireDataBuffer M
 
 // ============================== WITNESS ==============================
 
-static void _wipeWitnessSignature()
+static void _wipeAccountNode()
 {
-	// safer not to keep the signature in memory
-	explicit_bzero(WITNESS_CTX->stageData.witness.signature, SIZEOF(WITNESS_CTX->stageData.witness.signature));
+	// safer not to keep the keys in memory
+	explicit_bzero(&WITNESS_CTX->accountNode, SIZEOF(WITNESS_CTX->accountNode));
 	respond_with_user_reject();
 }
 
@@ -2394,13 +2557,27 @@ static void signTx_handleWitness_ui_runStep()
 		        "Sign using",
 		        "this witness?",
 		        this_fn,
-		        _wipeWitnessSignature
+		        _wipeAccountNode
 		);
 	}
 	UI_STEP(HANDLE_WITNESS_STEP_RESPOND) {
+		TRACE("TX HASH");
+		TRACE_BUFFER(ctx->txHash, SIZEOF(ctx->txHash));
+		TRACE("END TX HASH");
+
+		// the signature is computed only when responding and written directly into the response
+		write_view_t response = make_response_view();
+		uint8_t* signature = response.ptr;
+		view_skipBytes(&response, ED25519_SIGNATURE_LENGTH);
+		getWitnessWithAccountNode(
+		        &WITNESS_CTX->accountNode,
+		        &WITNESS_CTX->stageData.witness.path,
+		        ctx->txHash, SIZEOF(ctx->txHash),
+		        signature, ED25519_SIGNATURE_LENGTH
+		);
+
 		TRACE("Sending witness data");
-		TRACE_BUFFER(WITNESS_CTX->stageData.witness.signature, SIZEOF(WITNESS_CTX->stageData.witness.signature));
-		io_send_buf(SUCCESS, WITNESS_CTX->stageData.witness.signature, SIZEOF(WITNESS_CTX->stageData.witness.signature));
+		view_sendResponse(SUCCESS, &response);
 		ui_displayBusy(); // displays dots, called only after I/O to avoid freezing
 
 		WITNESS_CTX->currentWitness++;
@@ -2411,6 +2588,106 @@ static void signTx_handleWitness_ui_runStep()
 	UI_STEP_END(HANDLE_WITNESS_STEP_INVALID);
 }
 
+// the witness is computed in the last UI step, see signTx_handleWitness_ui_runStep
+static void _processWitness(security_policy_t policy)
+{
+	{
+		// choose UI steps
+		switch (policy) {
+#define  CASE(POLICY, UI_STEP) case POLICY: {ctx->ui_step=UI_STEP; break;}
+			CASE(POLICY_PROMPT_WARN_UNUSUAL, HANDLE_WITNESS_STEP_WARNING);
+			CASE(POLICY_SHOW_BEFORE_RESPONSE, HANDLE_WITNESS_STEP_DISPLAY);
+			CASE(POLICY_ALLOW_WITHOUT_PROMPT, HANDLE_WITNESS_STEP_RESPOND);
+#undef   CASE
+		default:
+			THROW(ERR_NOT_IMPLEMENTED);
+		}
+	}
+	signTx_handleWitness_ui_runStep();
+}
+
+// Several witness paths can be sent in a single APDU.
+// Signatures for the longest prefix of the paths that need no UI
+// are returned together (at most SIGN_TX_WITNESS_BATCH_MAX of them),
+// the host is supposed to resend the remaining paths.
+// If the first path needs a UI step, it is processed as a single witness.
+enum {
+	P2_WITNESS_BATCH = 0x01,
+};
+
+STATIC_ASSERT(
+        1 + SIZEOF(WITNESS_CTX->stageData.batchSignatures) + 2 <= SIZEOF(G_io_apdu_buffer),
+        "witness batch does not fit into a response APDU (including the sub-command count)"
+);
+
+__noinline_due_to_stack__
+static void _handleWitnessBatch(const uint8_t* wireDataBuffer, size_t wireDataSize)
+{
+	TRACE_BUFFER(wireDataBuffer, wireDataSize);
+
+	read_view_t view = make_read_view(wireDataBuffer, wireDataBuffer + wireDataSize);
+	VALIDATE(view_remainingSize(&view) > 0, ERR_INVALID_DATA);
+
+	size_t numSignatures = 0;
+	while (view_remainingSize(&view) > 0 && numSignatures < ARRAY_LEN(WITNESS_CTX->stageData.batchSignatures)) {
+		VALIDATE(WITNESS_CTX->currentWitness + numSignatures < ctx->numWitnesses, ERR_INVALID_DATA);
+
+		bip44_path_t path;
+		explicit_bzero(&path, SIZEOF(path));
+		view_skipBytes(&view, bip44_parseFromWire(&path, VIEW_REMAINING_TO_TUPLE_BUF_SIZE(&view)));
+
+		TRACE();
+		BIP44_PRINTF(&path);
+		PRINTF("\n");
+
+		security_policy_t policy = policyForSignTxWitness(
+		                                   ctx->commonTxData.txSigningMode,
+		                                   &path,
+		                                   ctx->includeMint,
+		                                   ctx->poolOwnerByPath ? &ctx->poolOwnerPath : NULL
+		                           );
+		TRACE("Policy: %d", (int) policy);
+		ENSURE_NOT_DENIED(policy);
+
+		if (policy != POLICY_ALLOW_WITHOUT_PROMPT) {
+			if (numSignatures == 0) {
+				// fall back to the UI flow for a single witness
+				explicit_bzero(&WITNESS_CTX->stageData, SIZEOF(WITNESS_CTX->stageData));
+				WITNESS_CTX->stageData.witness.path = path;
+				_processWitness(policy);
+				return;
+			}
+			// the remaining paths are to be resent
+			break;
+		}
+
+		getWitnessWithAccountNode(
+		        &WITNESS_CTX->accountNode,
+		        &path,
+		        ctx->txHash, SIZEOF(ctx->txHash),
+		        WITNESS_CTX->stageData.batchSignatures[numSignatures],
+		        SIZEOF(WITNESS_CTX->stageData.batchSignatures[numSignatures])
+		);
+		numSignatures++;
+	}
+
+	TRACE("Sending %u witness signatures", (unsigned) numSignatures);
+	ASSERT(numSignatures > 0);
+	io_send_buf(
+	        SUCCESS,
+	        (uint8_t*) WITNESS_CTX->stageData.batchSignatures,
+	        numSignatures * SIZEOF(WITNESS_CTX->stageData.batchSignatures[0])
+	);
+	// safer not to keep the signatures in memory
+	explicit_bzero(&WITNESS_CTX->stageData, SIZEOF(WITNESS_CTX->stageData));
+	ui_displayBusy(); // displays dots, called only after I/O to avoid freezing
+
+	WITNESS_CTX->currentWitness += numSignatures;
+	if (WITNESS_CTX->currentWitness == ctx->numWitnesses) {
+		advanceStage();
+	}
+}
+
 __noinline_due_to_stack__
 static void signTx_handleWitnessAPDU(uint8_t p2, const uint8_t* wireDataBuffer, size_t wireDataSize)
 {
@@ -2418,14 +2695,19 @@ static void signTx_handleWitnessAPDU(uint8_t p2, const uint8_t* wireDataBuffer,
 	{
 		// sanity checks
 		CHECK_STAGE(SIGN_STAGE_WITNESSES);
-		VALIDATE(p2 == P2_UNUSED, ERR_INVALID_REQUEST_PARAMETERS);
+		VALIDATE(p2 == P2_UNUSED || p2 == P2_WITNESS_BATCH, ERR_INVALID_REQUEST_PARAMETERS);
 		ASSERT(wireDataSize < BUFFER_SIZE_PARANOIA);
 
 		TRACE("Witness no. %d out of %d", WITNESS_CTX->currentWitness + 1, ctx->numWitnesses);
 		ASSERT(WITNESS_CTX->currentWitness < ctx->numWitnesses);
 	}
 
-	explicit_bzero(&WITNESS_CTX->stageData.witness, SIZEOF(WITNESS_CTX->stageData.witness));
+	explicit_bzero(&WITNESS_CTX->stageData, SIZEOF(WITNESS_CTX->stageData));
+
+	if (p2 == P2_WITNESS_BATCH) {
+		_handleWitnessBatch(wireDataBuffer, wireDataSize);
+		return;
+	}
 
 	{
 		// parse
@@ -2448,33 +2730,183 @@ static void signTx_handleWitnessAPDU(uint8_t p2, const uint8_t* wireDataBuffer,
 	TRACE("Policy: %d", (int) policy);
 	ENSURE_NOT_DENIED(policy);
 
-	{
-		// compute witness
-		TRACE("getWitness");
-		TRACE("TX HASH");
-		TRACE_BUFFER(ctx->txHash, SIZEOF(ctx->txHash));
-		TRACE("END TX HASH");
+	_processWitness(policy);
+}
 
-		getWitness(
-		        &WITNESS_CTX->stageData.witness.path,
-		        ctx->txHash, SIZEOF(ctx->txHash),
-		        WITNESS_CTX->stageData.witness.signature, SIZEOF(WITNESS_CTX->stageData.witness.signature)
-		);
+
+// ============================== SESSION ==============================
+
+enum {
+	P1_SESSION = 0x14,
+};
+
+enum {
+	P2_SESSION_GET_TOKEN = 0x00,
+	P2_SESSION_RESUME = 0x01,
+};
+
+bool signTx_isResumeRequest(uint8_t p1, uint8_t p2)
+{
+	return p1 == P1_SESSION && p2 == P2_SESSION_RESUME;
+}
+
+void signTx_wipeSecrets()
+{
+	// the account node only exists in the witness stage, otherwise the memory belongs to other stages
+	if (ctx->stage == SIGN_STAGE_WITNESSES) {
+		// a resumed tx derives the node again when needed
+		explicit_bzero(&WITNESS_CTX->accountNode, SIZEOF(WITNESS_CTX->accountNode));
 	}
+}
 
+__noinline_due_to_stack__
+static void signTx_handleSessionAPDU(uint8_t p2, const uint8_t* wireDataBuffer MARK_UNUSED, size_t wireDataSize)
+{
+	TRACE_STACK_USAGE();
 	{
-		// choose UI steps
-		switch (policy) {
-#define  CASE(POLICY, UI_STEP) case POLICY: {ctx->ui_step=UI_STEP; break;}
-			CASE(POLICY_PROMPT_WARN_UNUSUAL, HANDLE_WITNESS_STEP_WARNING);
-			CASE(POLICY_SHOW_BEFORE_RESPONSE, HANDLE_WITNESS_STEP_DISPLAY);
-			CASE(POLICY_ALLOW_WITHOUT_PROMPT, HANDLE_WITNESS_STEP_RESPOND);
+		// sanity checks
+		// resuming is handled separately, it must be the first call after a reset
+		VALIDATE(p2 == P2_SESSION_GET_TOKEN, ERR_INVALID_REQUEST_PARAMETERS);
+		ASSERT(wireDataSize < BUFFER_SIZE_PARANOIA);
+
+		VALIDATE(ctx->stage != SIGN_STAGE_INIT, ERR_INVALID_STATE);
+		VALIDATE(wireDataSize == 0, ERR_INVALID_DATA);
+	}
+
+	io_send_buf(SUCCESS, ctx->sessionToken, SIZEOF(ctx->sessionToken));
+	ui_displayBusy(); // needs to happen after I/O
+}
+
+// the request expected next and the number of such items already processed
+static void _getResumePosition(uint8_t* p1, uint16_t* numProcessed)
+{
+	*numProcessed = 0;
+
+	switch (ctx->stage) {
+#define  CASE(STAGE, P1) case STAGE: *p1 = P1; break;
+#define  CASE_WITH_COUNTER(STAGE, P1, COUNTER) case STAGE: *p1 = P1; *numProcessed = COUNTER; break;
+		CASE(SIGN_STAGE_AUX_DATA, 0x08);
+		CASE_WITH_COUNTER(SIGN_STAGE_BODY_INPUTS, 0x02, BODY_CTX->currentInput);
+		CASE_WITH_COUNTER(SIGN_STAGE_BODY_OUTPUTS, 0x03, BODY_CTX->currentOutput);
+		CASE(SIGN_STAGE_BODY_FEE, 0x04);
+		CASE(SIGN_STAGE_BODY_TTL, 0x05);
+		CASE_WITH_COUNTER(SIGN_STAGE_BODY_CERTIFICATES, 0x06, BODY_CTX->currentCertificate);
+		CASE_WITH_COUNTER(SIGN_STAGE_BODY_WITHDRAWALS, 0x07, BODY_CTX->currentWithdrawal);
+		CASE(SIGN_STAGE_BODY_VALIDITY_INTERVAL, 0x09);
+		CASE(SIGN_STAGE_BODY_MINT, 0x0b);
+		CASE(SIGN_STAGE_BODY_SCRIPT_DATA_HASH, 0x0c);
+		CASE_WITH_COUNTER(SIGN_STAGE_BODY_COLLATERAL_INPUTS, 0x0d, BODY_CTX->currentCollateral);
+		CASE_WITH_COUNTER(SIGN_STAGE_BODY_REQUIRED_SIGNERS, 0x0e, BODY_CTX->currentRequiredSigner);
+		CASE(SIGN_STAGE_BODY_COLLATERAL_OUTPUT, 0x12);
+		CASE(SIGN_STAGE_BODY_TOTAL_COLLATERAL, 0x10);
+		CASE_WITH_COUNTER(SIGN_STAGE_BODY_REFERENCE_INPUTS, 0x11, BODY_CTX->currentReferenceInput);
+		CASE(SIGN_STAGE_CONFIRM, 0x0a);
+		CASE_WITH_COUNTER(SIGN_STAGE_WITNESSES, 0x0f, WITNESS_CTX->currentWitness);
 #undef   CASE
-		default:
-			THROW(ERR_NOT_IMPLEMENTED);
+#undef   CASE_WITH_COUNTER
+	default:
+		// there is no session or it was interrupted inside a sub-machine
+		// (an output, a certificate, mint or a vote registration)
+		THROW(ERR_INVALID_STATE);
+	}
+}
+
+// Continues a session whose state has been kept in RAM across a transport reset.
+// Only possible if the reset came while waiting for the next request,
+// i.e. all processed items have been responded to and no UI step is pending.
+__noinline_due_to_stack__
+static void signTx_handleResumeAPDU(const uint8_t* wireDataBuffer, size_t wireDataSize)
+{
+	TRACE_STACK_USAGE();
+	{
+		// sanity checks
+		ASSERT(wireDataSize < BUFFER_SIZE_PARANOIA);
+
+		// the state is all zeros if there is nothing to resume
+		VALIDATE(ctx->stage != SIGN_STAGE_NONE, ERR_INVALID_STATE);
+		VALIDATE(ctx->stage != SIGN_STAGE_INIT, ERR_INVALID_STATE);
+	}
+	{
+		// a wrong token ends the session, so it cannot be guessed
+		VALIDATE(wireDataSize == SIZEOF(ctx->sessionToken), ERR_INVALID_DATA);
+		VALIDATE(!memcmp(wireDataBuffer, ctx->sessionToken, SIZEOF(ctx->sessionToken)), ERR_INVALID_DATA);
+	}
+
+	// the stage is advanced lazily, the last item might have finished a sub-machine
+	checkForFinishedSubmachines();
+
+	uint8_t p1 = 0;
+	uint16_t numProcessed = 0;
+	_getResumePosition(&p1, &numProcessed);
+	TRACE("Resuming at p1 = 0x%x, items processed = %u", p1, numProcessed);
+
+	uint8_t response[1 + 2] = {0};
+	response[0] = p1;
+	u2be_write(response + 1, numProcessed);
+
+	io_send_buf(SUCCESS, response, SIZEOF(response));
+	ui_displayBusy(); // needs to happen after I/O
+}
+
+
+// ============================== BATCH ==============================
+
+enum {
+	P1_BATCH = 0x13,
+};
+
+static void processSubcommand(uint8_t p1, uint8_t p2, const uint8_t* wireDataBuffer, size_t wireDataSize);
+
+// Runs several sub-commands packed into a single APDU
+// until the first one that needs a UI step or responds with data.
+// The response starts with the number of sub-commands processed,
+// the host is supposed to resend the remaining ones.
+__noinline_due_to_stack__
+static void signTx_handleBatchAPDU(uint8_t p2, const uint8_t* wireDataBuffer, size_t wireDataSize)
+{
+	TRACE_STACK_USAGE();
+	{
+		// sanity checks
+		VALIDATE(p2 == P2_UNUSED, ERR_INVALID_REQUEST_PARAMETERS);
+		ASSERT(wireDataSize < BUFFER_SIZE_PARANOIA);
+
+		VALIDATE(wireDataSize > 0, ERR_INVALID_DATA);
+	}
+
+	TRACE_BUFFER(wireDataBuffer, wireDataSize);
+
+	typedef struct {
+		uint8_t p1;
+		uint8_t p2;
+		uint8_t size;
+	} wire_subcommand_header_t;
+
+	read_view_t view = make_read_view(wireDataBuffer, wireDataBuffer + wireDataSize);
+
+	io_batch_begin();
+
+	while (view_remainingSize(&view) > 0) {
+		const wire_subcommand_header_t* header = view_parseRecord(&view, wire_subcommand_header_t);
+		const uint8_t subcommandP1 = header->p1;
+		const uint8_t subcommandP2 = header->p2;
+		const size_t subcommandSize = header->size;
+		TRACE("Sub-command: p1 = 0x%x, p2 = 0x%x, size = %u", subcommandP1, subcommandP2, subcommandSize);
+
+		// batches are not supposed to be nested
+		VALIDATE(subcommandP1 != P1_BATCH, ERR_INVALID_DATA);
+		VALIDATE(subcommandSize <= view_remainingSize(&view), ERR_INVALID_DATA);
+
+		io_batch_beginSubcommand();
+		processSubcommand(subcommandP1, subcommandP2, view.ptr, subcommandSize);
+		view_skipBytes(&view, subcommandSize);
+
+		if (!io_batch_canContinue()) {
+			// waiting for the user or the response has already been sent
+			break;
 		}
 	}
-	signTx_handleWitness_ui_runStep();
+
+	io_batch_end();
 }
 
 
@@ -2511,28 +2943,16 @@ static subhandler_fn_t* lookup_subhandler(uint8_t p1)
 		CASE(0x11, signTx_handleReferenceInputsAPDU);
 		CASE(0x0a, signTx_handleConfirmAPDU);
 		CASE(0x0f, signTx_handleWitnessAPDU);
+		CASE(P1_BATCH, signTx_handleBatchAPDU);
+		CASE(P1_SESSION, signTx_handleSessionAPDU);
 		DEFAULT(NULL)
 #undef   CASE
 #undef   DEFAULT
 	}
 }
 
-void signTx_handleAPDU(
-        uint8_t p1,
-        uint8_t p2,
-        const uint8_t* wireDataBuffer,
-        size_t wireDataSize,
-        bool isNewCall
-)
+static void processSubcommand(uint8_t p1, uint8_t p2, const uint8_t* wireDataBuffer, size_t wireDataSize)
 {
-	TRACE("P1 = 0x%x, P2 = 0x%x, isNewCall = %d", p1, p2, isNewCall);
-	ASSERT(wireDataSize < BUFFER_SIZE_PARANOIA);
-
-	if (isNewCall) {
-		explicit_bzero(ctx, SIZEOF(*ctx));
-		ctx->stage = SIGN_STAGE_INIT;
-	}
-
 	// advance stage if a state sub-machine has finished
 	checkForFinishedSubmachines();
 
@@ -2567,6 +2987,32 @@ void signTx_handleAPDU(
 	subhandler(p2, wireDataBuffer, wireDataSize);
 }
 
+void signTx_handleAPDU(
+        uint8_t p1,
+        uint8_t p2,
+        const uint8_t* wireDataBuffer,
+        size_t wireDataSize,
+        bool isNewCall
+)
+{
+	TRACE("P1 = 0x%x, P2 = 0x%x, isNewCall = %d", p1, p2, isNewCall);
+	ASSERT(wireDataSize < BUFFER_SIZE_PARANOIA);
+
+	if (signTx_isResumeRequest(p1, p2)) {
+		// the state of the interrupted session is kept only for the first call after a reset
+		VALIDATE(isNewCall, ERR_INVALID_STATE);
+		signTx_handleResumeAPDU(wireDataBuffer, wireDataSize);
+		return;
+	}
+
+	if (isNewCall) {
+		explicit_bzero(ctx, SIZEOF(*ctx));
+		ctx->stage = SIGN_STAGE_INIT;
+	}
+
+	processSubcommand(p1, p2, wireDataBuffer, wireDataSize);
+}
+
 ins_sign_tx_aux_data_context_t* accessAuxDataContext()
 {
 	switch (ctx->stage) {
@@ -12,6 +12,7 @@
 #include "signTxPoolRegistration.h"
 #include "signTxCVoteRegistration.h"
 #include "signTxAuxData.h"
+#include "messageSigning.h"
 
 // the signing mode significantly affects restrictions on tx being signed
 typedef enum {
@@ -104,9 +105,20 @@ typedef struct {
 	char label[UI_INPUT_LABEL_SIZE];
 } sign_tx_transaction_input_t;
 
+// inputs sharing the same tx hash, sent in a single APDU
+#define SIGN_TX_INPUT_GROUP_MAX_SIZE ((255 - TX_HASH_LENGTH) / 4)
+
+typedef struct {
+	const char* labelPrefix;
+	uint16_t firstInputNumber; // used in UI labels
+	uint8_t numInputs;
+	uint8_t currentInput;
+	uint32_t indices[SIGN_TX_INPUT_GROUP_MAX_SIZE];
+} sign_tx_input_group_t;
+
+// the signature is written directly into the response
 typedef struct {
 	bip44_path_t path;
-	uint8_t signature[64];
 } sign_tx_witness_data_t;
 
 typedef struct {
@@ -175,13 +187,22 @@ typedef struct {
 		pool_registration_context_t pool_registration_subctx;
 		output_context_t output_subctx;
 		mint_context_t mint_subctx;
+		sign_tx_input_group_t input_group_subctx;
 	} stageContext;
 } ins_sign_tx_body_context_t;
 
+#define SIGN_TX_SESSION_TOKEN_LENGTH 16
+
+// as many signatures as fit into a response APDU
+#define SIGN_TX_WITNESS_BATCH_MAX 4
+
 typedef struct {
 	uint16_t currentWitness;
-	struct {
+	// private keys reused by witnesses under the same account, wiped after the last witness
+	signing_account_node_t accountNode;
+	union {
 		sign_tx_witness_data_t witness;
+		uint8_t batchSignatures[SIGN_TX_WITNESS_BATCH_MAX][64];
 	} stageData;
 } ins_sign_tx_witness_context_t;
 
@@ -223,6 +244,8 @@ typedef struct {
 
 	bool shouldDisplayTxid; // long bytestrings (e.g. datums in outputs) are better verified indirectly
 
+	uint8_t sessionToken[SIGN_TX_SESSION_TOKEN_LENGTH]; // needed to resume the session after a transport reset
+
 	int ui_step;
 	void (*ui_advanceState)();
 } ins_sign_tx_context_t;
@@ -238,6 +261,11 @@ ins_sign_tx_witness_context_t* accessWitnessContext();
 
 handler_fn_t signTx_handleAPDU;
 
+bool signTx_isResumeRequest(uint8_t p1, uint8_t p2);
+
+// wipes private keys kept across APDUs
+void signTx_wipeSecrets();
+
 static inline bool signTx_parseIncluded(uint8_t value)
 {
 	switch (value) {
@@ -10,6 +10,7 @@
 #include "bufView.h"
 #include "securityPolicy.h"
 #include "messageSigning.h"
+#include "derivationCache.h"
 
 static common_tx_data_t* commonTxData = &(instructionState.signTxContext.commonTxData);
 
@@ -325,7 +326,7 @@ static void signTxCVoteRegistration_handleVoteKeyAPDU(const uint8_t* wireDataBuf
 
 		case DELEGATION_PATH: {
 			extendedPublicKey_t extVotePubKey;
-			deriveExtendedPublicKey(&subctx->stateData.delegation.votePubKeyPath, &extVotePubKey);
+			derivationCache_getExtendedPublicKey(&subctx->stateData.delegation.votePubKeyPath, &extVotePubKey);
 			auxDataHashBuilder_cVoteRegistration_addVoteKey(
 			        auxDataHashBuilder, extVotePubKey.pubKey, SIZEOF(extVotePubKey.pubKey)
 			);
@@ -444,7 +445,7 @@ static void signTxCVoteRegistration_handleDelegationAPDU(const uint8_t* wireData
 
 		case DELEGATION_PATH: {
 			extendedPublicKey_t extVotePubKey;
-			deriveExtendedPublicKey(&subctx->stateData.delegation.votePubKeyPath, &extVotePubKey);
+			derivationCache_getExtendedPublicKey(&subctx->stateData.delegation.votePubKeyPath, &extVotePubKey);
 			auxDataHashBuilder_cVoteRegistration_addDelegation(
 			        auxDataHashBuilder,
 			        extVotePubKey.pubKey, SIZEOF(extVotePubKey.pubKey),
@@ -548,7 +549,7 @@ static void signTxCVoteRegistration_handleStakingKeyAPDU(const uint8_t* wireData
 
 	{
 		extendedPublicKey_t extStakingPubKey;
-		deriveExtendedPublicKey(&subctx->stakingKeyPath, &extStakingPubKey);
+		derivationCache_getExtendedPublicKey(&subctx->stakingKeyPath, &extStakingPubKey);
 		auxDataHashBuilder_cVoteRegistration_addStakingKey(
 		        &AUX_DATA_CTX->auxDataHashBuilder, extStakingPubKey.pubKey, SIZEOF(extStakingPubKey.pubKey)
 		);
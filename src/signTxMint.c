@@ -248,7 +248,12 @@ static void signTxMint_handleToken_ui_runStep()
 		);
 	}
 	UI_STEP(HANDLE_TOKEN_STEP_RESPOND) {
-		respondSuccessEmptyMsg();
+		if (subctx->stateData.isTokenBatch) {
+			// only the shown token has been processed
+			respondWithNumTokensProcessed(1);
+		} else {
+			respondSuccessEmptyMsg();
+		}
 
 		ASSERT(subctx->currentToken < subctx->numTokens);
 		subctx->currentToken++;
@@ -260,6 +265,33 @@ static void signTxMint_handleToken_ui_runStep()
 	UI_STEP_END(HANDLE_TOKEN_STEP_INVALID);
 }
 
+static void _selectTokenUiStep()
+{
+	mint_context_t* subctx = accessSubcontext();
+
+	switch (subctx->mintSecurityPolicy) {
+#define  CASE(POLICY, UI_STEP) case POLICY: {subctx->ui_step=UI_STEP; break;}
+		CASE(POLICY_SHOW_BEFORE_RESPONSE, HANDLE_TOKEN_STEP_DISPLAY_NAME);
+		CASE(POLICY_ALLOW_WITHOUT_PROMPT, HANDLE_TOKEN_STEP_RESPOND);
+#undef   CASE
+	default:
+		THROW(ERR_NOT_IMPLEMENTED);
+	}
+}
+
+static void _addTokenToTxHash()
+{
+	mint_context_t* subctx = accessSubcontext();
+
+	TRACE("Adding token to tx hash");
+	txHashBuilder_addMint_token(
+	        &BODY_CTX->txHashBuilder,
+	        subctx->stateData.token.assetNameBytes, subctx->stateData.token.assetNameSize,
+	        subctx->stateData.token.amount
+	);
+	TRACE();
+}
+
 static void signTxMint_handleTokenAPDU(const uint8_t* wireDataBuffer, size_t wireDataSize)
 {
 	{
@@ -269,6 +301,7 @@ static void signTxMint_handleTokenAPDU(const uint8_t* wireDataBuffer, size_t wir
 		ASSERT(wireDataSize < BUFFER_SIZE_PARANOIA);
 	}
 	mint_context_t* subctx = accessSubcontext();
+	subctx->stateData.isTokenBatch = false;
 	{
 		mint_token_amount_t* token = &subctx->stateData.token;
 
@@ -299,30 +332,75 @@ static void signTxMint_handleTokenAPDU(const uint8_t* wireDataBuffer, size_t wir
 		VALIDATE(view_remainingSize(&view) == 0, ERR_INVALID_DATA);
 	}
 
+	_selectTokenUiStep();
+	_addTokenToTxHash();
+
+	signTxMint_handleToken_ui_runStep();
+}
+
+static void _parseBatchToken(read_view_t* view)
+{
+	mint_context_t* subctx = accessSubcontext();
+	mint_token_amount_t* token = &subctx->stateData.token;
+
+	STATIC_ASSERT(SIZEOF(token->assetNameBytes) >= ASSET_NAME_SIZE_MAX, "wrong asset name buffer size");
+	view_parseDeltaCodedAssetName(
+	        view,
+	        token->assetNameBytes, &token->assetNameSize,
+	        subctx->currentToken == 0
+	);
+
+	token->amount = parse_int64be(view);
+	TRACE_INT64(token->amount);
+}
+
+// Several tokens of the current asset group in a single APDU.
+// If the tokens are to be shown, only the first one is processed.
+// The response contains the number of tokens processed.
+static void signTxMint_handleTokenBatchAPDU(const uint8_t* wireDataBuffer, size_t wireDataSize)
+{
 	{
-		// select UI step
-		switch (subctx->mintSecurityPolicy) {
-#define  CASE(POLICY, UI_STEP) case POLICY: {subctx->ui_step=UI_STEP; break;}
-			CASE(POLICY_SHOW_BEFORE_RESPONSE, HANDLE_TOKEN_STEP_DISPLAY_NAME);
-			CASE(POLICY_ALLOW_WITHOUT_PROMPT, HANDLE_TOKEN_STEP_RESPOND);
-#undef   CASE
-		default:
-			THROW(ERR_NOT_IMPLEMENTED);
-		}
+		// sanity checks
+		CHECK_STATE(STATE_MINT_TOKEN);
+
+		ASSERT(wireDataSize < BUFFER_SIZE_PARANOIA);
 	}
+	mint_context_t* subctx = accessSubcontext();
+	subctx->stateData.isTokenBatch = true;
 
-	{
-		// add token group to tx
-		TRACE("Adding token group hash to tx hash");
-		txHashBuilder_addMint_token(
-		        &BODY_CTX->txHashBuilder,
-		        subctx->stateData.token.assetNameBytes, subctx->stateData.token.assetNameSize,
-		        subctx->stateData.token.amount
-		);
-		TRACE();
+	TRACE_BUFFER(wireDataBuffer, wireDataSize);
+	read_view_t view = make_read_view(wireDataBuffer, wireDataBuffer + wireDataSize);
+
+	const size_t batchSize = parse_u1be(&view);
+	ASSERT(subctx->currentToken < subctx->numTokens);
+	VALIDATE(batchSize > 0, ERR_INVALID_DATA);
+	VALIDATE(batchSize <= (size_t) (subctx->numTokens - subctx->currentToken), ERR_INVALID_DATA);
+
+	if (subctx->mintSecurityPolicy != POLICY_ALLOW_WITHOUT_PROMPT) {
+		// the rest of the batch is supposed to be sent again
+		_parseBatchToken(&view);
+
+		_selectTokenUiStep();
+		_addTokenToTxHash();
+
+		signTxMint_handleToken_ui_runStep();
+		return;
 	}
 
-	signTxMint_handleToken_ui_runStep();
+	for (size_t i = 0; i < batchSize; i++) {
+		_parseBatchToken(&view);
+		_addTokenToTxHash();
+
+		ASSERT(subctx->currentToken < subctx->numTokens);
+		subctx->currentToken++;
+	}
+	VALIDATE(view_remainingSize(&view) == 0, ERR_INVALID_DATA);
+
+	respondWithNumTokensProcessed(batchSize);
+
+	if (subctx->currentToken == subctx->numTokens) {
+		advanceState();
+	}
 }
 
 enum {
@@ -393,6 +471,7 @@ enum {
 	APDU_INSTRUCTION_ASSET_GROUP = 0x31,
 	APDU_INSTRUCTION_TOKEN = 0x32,
 	APDU_INSTRUCTION_CONFIRM = 0x33,
+	APDU_INSTRUCTION_TOKEN_BATCH = 0x3a,
 };
 
 bool signTxMint_isValidInstruction(uint8_t p2)
@@ -401,6 +480,7 @@ bool signTxMint_isValidInstruction(uint8_t p2)
 	case APDU_INSTRUCTION_TOP_LEVEL_DATA:
 	case APDU_INSTRUCTION_ASSET_GROUP:
 	case APDU_INSTRUCTION_TOKEN:
+	case APDU_INSTRUCTION_TOKEN_BATCH:
 	case APDU_INSTRUCTION_CONFIRM:
 		return true;
 
@@ -435,6 +515,10 @@ void signTxMint_handleAPDU(uint8_t p2, const uint8_t* wireDataBuffer, size_t wir
 		signTxMint_handleTokenAPDU(wireDataBuffer, wireDataSize);
 		break;
 
+	case APDU_INSTRUCTION_TOKEN_BATCH:
+		signTxMint_handleTokenBatchAPDU(wireDataBuffer, wireDataSize);
+		break;
+
 	case APDU_INSTRUCTION_CONFIRM:
 		signTxMint_handleConfirmAPDU(wireDataBuffer, wireDataSize);
 		break;
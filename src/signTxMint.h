@@ -42,6 +42,7 @@ typedef struct {
 		struct {
 			token_group_t tokenGroup;
 			mint_token_amount_t token;
+			bool isTokenBatch; // affects the response
 		};
 	} stateData;
 
@@ -449,12 +449,21 @@ static void parseTopLevelData(const uint8_t* wireDataBuffer, size_t wireDataSize
 
 		view_parseDestination(&view, &subctx->stateData.destination);
 
-		uint64_t adaAmount = parse_u8be(&view);
+		typedef struct {
+			uint8_t adaAmount[8];
+			uint8_t numAssetGroups[4];
+			uint8_t includeDatum;
+			uint8_t includeRefScript;
+		} wire_output_values_t;
+
+		const wire_output_values_t* wireValues = view_parseRecord(&view, wire_output_values_t);
+
+		uint64_t adaAmount = u8be_read(wireValues->adaAmount);
 		subctx->stateData.adaAmount = adaAmount;
 		TRACE("Amount: %u.%06u", (unsigned) (adaAmount / 1000000), (unsigned)(adaAmount % 1000000));
 		VALIDATE(adaAmount < LOVELACE_MAX_SUPPLY, ERR_INVALID_DATA);
 
-		uint32_t numAssetGroups = parse_u4be(&view);
+		uint32_t numAssetGroups = u4be_read(wireValues->numAssetGroups);
 		TRACE("num asset groups %u", numAssetGroups);
 		VALIDATE(numAssetGroups <= OUTPUT_ASSET_GROUPS_MAX, ERR_INVALID_DATA);
 
@@ -462,10 +471,10 @@ static void parseTopLevelData(const uint8_t* wireDataBuffer, size_t wireDataSize
 		ASSERT_TYPE(subctx->numAssetGroups, uint16_t);
 		subctx->numAssetGroups = (uint16_t) numAssetGroups;
 
-		subctx->includeDatum = signTx_parseIncluded(parse_u1be(&view));
+		subctx->includeDatum = signTx_parseIncluded(wireValues->includeDatum);
 		TRACE("includeDatum = %d", (int) subctx->includeDatum);
 
-		subctx->includeRefScript = signTx_parseIncluded(parse_u1be(&view));
+		subctx->includeRefScript = signTx_parseIncluded(wireValues->includeRefScript);
 		TRACE("includeRefScript = %d", (int) subctx->includeRefScript);
 
 		if (subctx->includeDatum || subctx->includeRefScript) {
@@ -820,7 +829,12 @@ static void handleToken_ui_runStep()
 		);
 	}
 	UI_STEP(HANDLE_TOKEN_STEP_RESPOND) {
-		respondSuccessEmptyMsg();
+		if (subctx->stateData.isTokenBatch) {
+			// only the shown token has been processed
+			respondWithNumTokensProcessed(1);
+		} else {
+			respondSuccessEmptyMsg();
+		}
 
 		ASSERT(subctx->stateData.currentToken < subctx->stateData.numTokens);
 		subctx->stateData.currentToken++;
@@ -832,6 +846,51 @@ static void handleToken_ui_runStep()
 	UI_STEP_END(HANDLE_TOKEN_STEP_INVALID);
 }
 
+static void _addTokenToTxHash()
+{
+	output_context_t* subctx = accessSubcontext();
+
+	TRACE("Adding token to tx hash");
+	switch (ctx->stage) {
+
+	case SIGN_STAGE_BODY_OUTPUTS_SUBMACHINE:
+		TRACE();
+		txHashBuilder_addOutput_token(
+		        &BODY_CTX->txHashBuilder,
+		        subctx->stateData.token.assetNameBytes, subctx->stateData.token.assetNameSize,
+		        subctx->stateData.token.amount
+		);
+		break;
+
+	case SIGN_STAGE_BODY_COLLATERAL_OUTPUT_SUBMACHINE:
+		TRACE();
+		txHashBuilder_addCollateralOutput_token(
+		        &BODY_CTX->txHashBuilder,
+		        subctx->stateData.token.assetNameBytes, subctx->stateData.token.assetNameSize,
+		        subctx->stateData.token.amount
+		);
+		break;
+
+	default:
+		ASSERT(false);
+	}
+}
+
+static void _selectTokenUiStep()
+{
+	output_context_t* subctx = accessSubcontext();
+
+	switch (subctx->outputTokensSecurityPolicy) {
+#define  CASE(POLICY, UI_STEP) case POLICY: {subctx->ui_step=UI_STEP; break;}
+		CASE(POLICY_PROMPT_WARN_UNUSUAL, HANDLE_TOKEN_STEP_DISPLAY_NAME);
+		CASE(POLICY_SHOW_BEFORE_RESPONSE, HANDLE_TOKEN_STEP_DISPLAY_NAME);
+		CASE(POLICY_ALLOW_WITHOUT_PROMPT, HANDLE_TOKEN_STEP_RESPOND);
+#undef   CASE
+	default:
+		THROW(ERR_NOT_IMPLEMENTED);
+	}
+}
+
 static void handleTokenAPDU(const uint8_t* wireDataBuffer, size_t wireDataSize)
 {
 	{
@@ -841,6 +900,7 @@ static void handleTokenAPDU(const uint8_t* wireDataBuffer, size_t wireDataSize)
 		ASSERT(wireDataSize < BUFFER_SIZE_PARANOIA);
 	}
 	output_context_t* subctx = accessSubcontext();
+	subctx->stateData.isTokenBatch = false;
 	{
 		output_token_amount_t* token = &subctx->stateData.token;
 
@@ -870,46 +930,76 @@ static void handleTokenAPDU(const uint8_t* wireDataBuffer, size_t wireDataSize)
 
 		VALIDATE(view_remainingSize(&view) == 0, ERR_INVALID_DATA);
 	}
-	{
-		// add token group to tx
-		TRACE("Adding token group hash to tx hash");
-		switch (ctx->stage) {
 
-		case SIGN_STAGE_BODY_OUTPUTS_SUBMACHINE:
-			TRACE();
-			txHashBuilder_addOutput_token(
-			        &BODY_CTX->txHashBuilder,
-			        subctx->stateData.token.assetNameBytes, subctx->stateData.token.assetNameSize,
-			        subctx->stateData.token.amount
-			);
-			break;
+	_addTokenToTxHash();
 
-		case SIGN_STAGE_BODY_COLLATERAL_OUTPUT_SUBMACHINE:
-			TRACE();
-			txHashBuilder_addCollateralOutput_token(
-			        &BODY_CTX->txHashBuilder,
-			        subctx->stateData.token.assetNameBytes, subctx->stateData.token.assetNameSize,
-			        subctx->stateData.token.amount
-			);
-			break;
+	_selectTokenUiStep();
+	handleToken_ui_runStep();
+}
 
-		default:
-			ASSERT(false);
-		}
-	}
+// ============================== TOKEN BATCH ==============================
+
+static void _parseBatchToken(read_view_t* view)
+{
+	output_context_t* subctx = accessSubcontext();
+	output_token_amount_t* token = &subctx->stateData.token;
+
+	STATIC_ASSERT(SIZEOF(token->assetNameBytes) >= ASSET_NAME_SIZE_MAX, "wrong asset name buffer size");
+	view_parseDeltaCodedAssetName(
+	        view,
+	        token->assetNameBytes, &token->assetNameSize,
+	        subctx->stateData.currentToken == 0
+	);
+
+	token->amount = parse_u8be(view);
+	TRACE_UINT64(token->amount);
+}
+
+// Several tokens of the current asset group in a single APDU.
+// If the tokens are to be shown, only the first one is processed.
+// The response contains the number of tokens processed.
+static void handleTokenBatchAPDU(const uint8_t* wireDataBuffer, size_t wireDataSize)
+{
 	{
-		// select UI step
-		switch (subctx->outputTokensSecurityPolicy) {
-#define  CASE(POLICY, UI_STEP) case POLICY: {subctx->ui_step=UI_STEP; break;}
-			CASE(POLICY_PROMPT_WARN_UNUSUAL, HANDLE_TOKEN_STEP_DISPLAY_NAME);
-			CASE(POLICY_SHOW_BEFORE_RESPONSE, HANDLE_TOKEN_STEP_DISPLAY_NAME);
-			CASE(POLICY_ALLOW_WITHOUT_PROMPT, HANDLE_TOKEN_STEP_RESPOND);
-#undef   CASE
-		default:
-			THROW(ERR_NOT_IMPLEMENTED);
-		}
+		// sanity checks
+		CHECK_STATE(STATE_OUTPUT_TOKEN);
+
+		ASSERT(wireDataSize < BUFFER_SIZE_PARANOIA);
+	}
+	output_context_t* subctx = accessSubcontext();
+	subctx->stateData.isTokenBatch = true;
+
+	TRACE_BUFFER(wireDataBuffer, wireDataSize);
+	read_view_t view = make_read_view(wireDataBuffer, wireDataBuffer + wireDataSize);
 
+	const size_t batchSize = parse_u1be(&view);
+	ASSERT(subctx->stateData.currentToken < subctx->stateData.numTokens);
+	VALIDATE(batchSize > 0, ERR_INVALID_DATA);
+	VALIDATE(batchSize <= (size_t) (subctx->stateData.numTokens - subctx->stateData.currentToken), ERR_INVALID_DATA);
+
+	if (subctx->outputTokensSecurityPolicy != POLICY_ALLOW_WITHOUT_PROMPT) {
+		// the rest of the batch is supposed to be sent again
+		_parseBatchToken(&view);
+		_addTokenToTxHash();
+
+		_selectTokenUiStep();
 		handleToken_ui_runStep();
+		return;
+	}
+
+	for (size_t i = 0; i < batchSize; i++) {
+		_parseBatchToken(&view);
+		_addTokenToTxHash();
+
+		ASSERT(subctx->stateData.currentToken < subctx->stateData.numTokens);
+		subctx->stateData.currentToken++;
+	}
+	VALIDATE(view_remainingSize(&view) == 0, ERR_INVALID_DATA);
+
+	respondWithNumTokensProcessed(batchSize);
+
+	if (subctx->stateData.currentToken == subctx->stateData.numTokens) {
+		advanceState();
 	}
 }
 
@@ -1005,8 +1095,8 @@ static void signTxOutput_handleDatumInline_ui_runStep()
 		ASSERT(strlen(l1) + 1 < SIZEOF(l1));
 
 		char l2[20];
-		size_t prefixLength = MIN(subctx->stateData.datumChunkSize, 6);
-		size_t len = encode_hex(subctx->stateData.datumChunk, prefixLength, l2, SIZEOF(l2));
+		size_t prefixLength = MIN(subctx->stateData.datumChunkSize, SIZEOF(subctx->stateData.datumPrefix));
+		size_t len = encode_hex(subctx->stateData.datumPrefix, prefixLength, l2, SIZEOF(l2));
 		snprintf(l2 + len, SIZEOF(l2) - len, "...");
 		ASSERT(strlen(l2) + 1 < SIZEOF(l2));
 
@@ -1026,6 +1116,7 @@ static void signTxOutput_handleDatumInline_ui_runStep()
 static void handleDatumInline(read_view_t* view)
 {
 	output_context_t* subctx = accessSubcontext();
+	const uint8_t* chunk = NULL;
 	{
 		// parse data
 		subctx->stateData.datumRemainingBytes = parse_u4be(view);
@@ -1038,10 +1129,15 @@ static void handleDatumInline(read_view_t* view)
 		VALIDATE(chunkSize <= MAX_CHUNK_SIZE, ERR_INVALID_DATA);
 		VALIDATE(chunkSize <= subctx->stateData.datumRemainingBytes, ERR_INVALID_DATA);
 
-		view_parseBuffer(subctx->stateData.datumChunk, view, chunkSize);
+		chunk = view_borrowBuffer(view, chunkSize);
 		VALIDATE(view_remainingSize(view) == 0, ERR_INVALID_DATA);
 
 		subctx->stateData.datumChunkSize = chunkSize;
+		memmove(
+		        subctx->stateData.datumPrefix, chunk,
+		        MIN(chunkSize, SIZEOF(subctx->stateData.datumPrefix))
+		);
+		subctx->stateData.datumChunksCompressed = false;
 	}
 	{
 		// add to tx
@@ -1053,7 +1149,7 @@ static void handleDatumInline(read_view_t* view)
 		);
 		txHashBuilder_addOutput_datum_inline_chunk(
 		        &BODY_CTX->txHashBuilder,
-		        subctx->stateData.datumChunk, subctx->stateData.datumChunkSize
+		        chunk, subctx->stateData.datumChunkSize
 		);
 	}
 	{
@@ -1119,6 +1215,8 @@ static void handleDatumChunkAPDU(const uint8_t* wireDataBuffer, size_t wireDataS
 		ASSERT(wireDataSize < BUFFER_SIZE_PARANOIA);
 	}
 	output_context_t* subctx = accessSubcontext();
+	// raw data would be missing in the decompressor window
+	VALIDATE(!subctx->stateData.datumChunksCompressed, ERR_INVALID_DATA);
 	{
 		TRACE_BUFFER(wireDataBuffer, wireDataSize);
 
@@ -1132,17 +1230,16 @@ static void handleDatumChunkAPDU(const uint8_t* wireDataBuffer, size_t wireDataS
 		VALIDATE(chunkSize <= subctx->stateData.datumRemainingBytes, ERR_INVALID_DATA);
 		subctx->stateData.datumRemainingBytes -= chunkSize;
 
-		view_parseBuffer(subctx->stateData.datumChunk, &view, chunkSize);
+		const uint8_t* chunk = view_borrowBuffer(&view, chunkSize);
 		VALIDATE(view_remainingSize(&view) == 0, ERR_INVALID_DATA);
 
 		subctx->stateData.datumChunkSize = chunkSize;
-	}
-	{
+
 		// add to tx
 		TRACE("Adding inline datum chunk to tx hash");
 		txHashBuilder_addOutput_datum_inline_chunk(
 		        &BODY_CTX->txHashBuilder,
-		        subctx->stateData.datumChunk, subctx->stateData.datumChunkSize
+		        chunk, chunkSize
 		);
 	}
 	respondSuccessEmptyMsg();
@@ -1151,6 +1248,61 @@ static void handleDatumChunkAPDU(const uint8_t* wireDataBuffer, size_t wireDataS
 	}
 }
 
+static void _addDatumChunkToTxHash(const uint8_t* buffer, size_t bufferSize)
+{
+	txHashBuilder_addOutput_datum_inline_chunk(&BODY_CTX->txHashBuilder, buffer, bufferSize);
+}
+
+static void handleDatumChunkCompressedAPDU(const uint8_t* wireDataBuffer, size_t wireDataSize)
+{
+	{
+		// sanity checks
+		CHECK_STATE(STATE_OUTPUT_DATUM_INLINE_CHUNKS);
+		ASSERT(wireDataSize < BUFFER_SIZE_PARANOIA);
+	}
+	output_context_t* subctx = accessSubcontext();
+	{
+		TRACE_BUFFER(wireDataBuffer, wireDataSize);
+
+		read_view_t view = make_read_view(wireDataBuffer, wireDataBuffer + wireDataSize);
+
+		const size_t chunkSize = parse_u4be(&view);
+		TRACE("chunkSize = %u", chunkSize);
+		VALIDATE(chunkSize > 0, ERR_INVALID_DATA);
+		VALIDATE(chunkSize <= MAX_CHUNK_SIZE, ERR_INVALID_DATA);
+
+		const uint8_t* chunk = view_borrowBuffer(&view, chunkSize);
+		VALIDATE(view_remainingSize(&view) == 0, ERR_INVALID_DATA);
+
+		if (!subctx->stateData.datumChunksCompressed) {
+			lz_init(&subctx->stateData.datumDecompressor);
+			subctx->stateData.datumChunksCompressed = true;
+		}
+
+		// add to tx
+		TRACE("Adding decompressed inline datum chunk to tx hash");
+		const size_t decompressedSize = lz_decompressChunk(
+		                                        &subctx->stateData.datumDecompressor,
+		                                        chunk, chunkSize,
+		                                        subctx->stateData.datumRemainingBytes,
+		                                        _addDatumChunkToTxHash
+		                                );
+		TRACE("decompressedSize = %u", decompressedSize);
+
+		ASSERT(decompressedSize <= subctx->stateData.datumRemainingBytes);
+		subctx->stateData.datumRemainingBytes -= decompressedSize;
+
+		if (subctx->stateData.datumRemainingBytes == 0) {
+			// the compressed data must not end in the middle of an item
+			VALIDATE(lz_isAtItemBoundary(&subctx->stateData.datumDecompressor), ERR_INVALID_DATA);
+		}
+	}
+	respondSuccessEmptyMsg();
+	if (subctx->stateData.datumRemainingBytes == 0) {
+		advanceState();
+	}
+}
+
 // ========================== REFERENCE SCRIPT =============================
 
 enum {
@@ -1175,8 +1327,8 @@ static void handleRefScript_ui_runStep()
 		ASSERT(strlen(l1) + 1 < SIZEOF(l1));
 
 		char l2[20];
-		size_t prefixLength = MIN(subctx->stateData.refScriptChunkSize, 6);
-		size_t len = encode_hex(subctx->stateData.scriptChunk, prefixLength, l2, SIZEOF(l2));
+		size_t prefixLength = MIN(subctx->stateData.refScriptChunkSize, SIZEOF(subctx->stateData.scriptPrefix));
+		size_t len = encode_hex(subctx->stateData.scriptPrefix, prefixLength, l2, SIZEOF(l2));
 		snprintf(l2 + len, SIZEOF(l2) - len, "...");
 		ASSERT(strlen(l2) + 1 < SIZEOF(l2));
 
@@ -1201,6 +1353,7 @@ static void handleRefScriptAPDU(const uint8_t* wireDataBuffer, size_t wireDataSi
 		ASSERT(wireDataSize < BUFFER_SIZE_PARANOIA);
 	}
 	output_context_t* subctx = accessSubcontext();
+	const uint8_t* chunk = NULL;
 	{
 		TRACE_BUFFER(wireDataBuffer, wireDataSize);
 
@@ -1217,10 +1370,15 @@ static void handleRefScriptAPDU(const uint8_t* wireDataBuffer, size_t wireDataSi
 		VALIDATE(chunkSize <= MAX_CHUNK_SIZE, ERR_INVALID_DATA);
 		VALIDATE(chunkSize <= subctx->stateData.refScriptRemainingBytes, ERR_INVALID_DATA);
 
-		view_parseBuffer(subctx->stateData.scriptChunk, &view, chunkSize);
+		chunk = view_borrowBuffer(&view, chunkSize);
 		VALIDATE(view_remainingSize(&view) == 0, ERR_INVALID_DATA);
 
 		subctx->stateData.refScriptChunkSize = chunkSize;
+		memmove(
+		        subctx->stateData.scriptPrefix, chunk,
+		        MIN(chunkSize, SIZEOF(subctx->stateData.scriptPrefix))
+		);
+		subctx->stateData.refScriptChunksCompressed = false;
 	}
 	{
 		// add to tx
@@ -1231,7 +1389,7 @@ static void handleRefScriptAPDU(const uint8_t* wireDataBuffer, size_t wireDataSi
 		);
 		txHashBuilder_addOutput_referenceScript_dataChunk(
 		        &BODY_CTX->txHashBuilder,
-		        subctx->stateData.scriptChunk, subctx->stateData.refScriptChunkSize
+		        chunk, subctx->stateData.refScriptChunkSize
 		);
 	}
 	{
@@ -1265,6 +1423,8 @@ static void handleRefScriptChunkAPDU(const uint8_t* wireDataBuffer, size_t wireD
 		ASSERT(wireDataSize < BUFFER_SIZE_PARANOIA);
 	}
 	output_context_t* subctx = accessSubcontext();
+	// raw data would be missing in the decompressor window
+	VALIDATE(!subctx->stateData.refScriptChunksCompressed, ERR_INVALID_DATA);
 	{
 		TRACE_BUFFER(wireDataBuffer, wireDataSize);
 
@@ -1278,17 +1438,16 @@ static void handleRefScriptChunkAPDU(const uint8_t* wireDataBuffer, size_t wireD
 		VALIDATE(chunkSize <= subctx->stateData.refScriptRemainingBytes, ERR_INVALID_DATA);
 		subctx->stateData.refScriptRemainingBytes -= chunkSize;
 
-		view_parseBuffer(subctx->stateData.scriptChunk, &view, chunkSize);
+		const uint8_t* chunk = view_borrowBuffer(&view, chunkSize);
 		VALIDATE(view_remainingSize(&view) == 0, ERR_INVALID_DATA);
 
 		subctx->stateData.refScriptChunkSize = chunkSize;
-	}
-	{
+
 		// add to tx
 		TRACE("Adding inline datum chunk to tx hash");
 		txHashBuilder_addOutput_referenceScript_dataChunk(
 		        &BODY_CTX->txHashBuilder,
-		        subctx->stateData.scriptChunk, subctx->stateData.refScriptChunkSize
+		        chunk, chunkSize
 		);
 	}
 	respondSuccessEmptyMsg();
@@ -1297,6 +1456,61 @@ static void handleRefScriptChunkAPDU(const uint8_t* wireDataBuffer, size_t wireD
 	}
 }
 
+static void _addRefScriptChunkToTxHash(const uint8_t* buffer, size_t bufferSize)
+{
+	txHashBuilder_addOutput_referenceScript_dataChunk(&BODY_CTX->txHashBuilder, buffer, bufferSize);
+}
+
+static void handleRefScriptChunkCompressedAPDU(const uint8_t* wireDataBuffer, size_t wireDataSize)
+{
+	{
+		// sanity checks
+		CHECK_STATE(STATE_OUTPUT_REFERENCE_SCRIPT_CHUNKS);
+		ASSERT(wireDataSize < BUFFER_SIZE_PARANOIA);
+	}
+	output_context_t* subctx = accessSubcontext();
+	{
+		TRACE_BUFFER(wireDataBuffer, wireDataSize);
+
+		read_view_t view = make_read_view(wireDataBuffer, wireDataBuffer + wireDataSize);
+
+		const size_t chunkSize = parse_u4be(&view);
+		TRACE("chunkSize = %u", chunkSize);
+		VALIDATE(chunkSize > 0, ERR_INVALID_DATA);
+		VALIDATE(chunkSize <= MAX_CHUNK_SIZE, ERR_INVALID_DATA);
+
+		const uint8_t* chunk = view_borrowBuffer(&view, chunkSize);
+		VALIDATE(view_remainingSize(&view) == 0, ERR_INVALID_DATA);
+
+		if (!subctx->stateData.refScriptChunksCompressed) {
+			lz_init(&subctx->stateData.refScriptDecompressor);
+			subctx->stateData.refScriptChunksCompressed = true;
+		}
+
+		// add to tx
+		TRACE("Adding decompressed reference script chunk to tx hash");
+		const size_t decompressedSize = lz_decompressChunk(
+		                                        &subctx->stateData.refScriptDecompressor,
+		                                        chunk, chunkSize,
+		                                        subctx->stateData.refScriptRemainingBytes,
+		                                        _addRefScriptChunkToTxHash
+		                                );
+		TRACE("decompressedSize = %u", decompressedSize);
+
+		ASSERT(decompressedSize <= subctx->stateData.refScriptRemainingBytes);
+		subctx->stateData.refScriptRemainingBytes -= decompressedSize;
+
+		if (subctx->stateData.refScriptRemainingBytes == 0) {
+			// the compressed data must not end in the middle of an item
+			VALIDATE(lz_isAtItemBoundary(&subctx->stateData.refScriptDecompressor), ERR_INVALID_DATA);
+		}
+	}
+	respondSuccessEmptyMsg();
+	if (subctx->stateData.refScriptRemainingBytes == 0) {
+		advanceState();
+	}
+}
+
 // ============================== CONFIRM ==============================
 
 enum {
@@ -1408,6 +1622,9 @@ enum {
 	APDU_INSTRUCTION_DATUM_CHUNK = 0x35,
 	APDU_INSTRUCTION_REF_SCRIPT = 0x36,
 	APDU_INSTRUCTION_REF_SCRIPT_CHUNK = 0x37,
+	APDU_INSTRUCTION_DATUM_CHUNK_COMPRESSED = 0x38,
+	APDU_INSTRUCTION_REF_SCRIPT_CHUNK_COMPRESSED = 0x39,
+	APDU_INSTRUCTION_TOKEN_BATCH = 0x3a,
 	APDU_INSTRUCTION_CONFIRM = 0x33,
 };
 
@@ -1421,6 +1638,9 @@ bool signTxOutput_isValidInstruction(uint8_t p2)
 	case APDU_INSTRUCTION_DATUM_CHUNK:
 	case APDU_INSTRUCTION_REF_SCRIPT:
 	case APDU_INSTRUCTION_REF_SCRIPT_CHUNK:
+	case APDU_INSTRUCTION_DATUM_CHUNK_COMPRESSED:
+	case APDU_INSTRUCTION_REF_SCRIPT_CHUNK_COMPRESSED:
+	case APDU_INSTRUCTION_TOKEN_BATCH:
 	case APDU_INSTRUCTION_CONFIRM:
 		return true;
 
@@ -1446,6 +1666,10 @@ void signTxOutput_handleAPDU(uint8_t p2, const uint8_t* wireDataBuffer, size_t w
 		handleTokenAPDU(wireDataBuffer, wireDataSize);
 		break;
 
+	case APDU_INSTRUCTION_TOKEN_BATCH:
+		handleTokenBatchAPDU(wireDataBuffer, wireDataSize);
+		break;
+
 	case APDU_INSTRUCTION_DATUM:
 		handleDatumAPDU(wireDataBuffer, wireDataSize);
 		break;
@@ -1462,6 +1686,14 @@ void signTxOutput_handleAPDU(uint8_t p2, const uint8_t* wireDataBuffer, size_t w
 		handleRefScriptChunkAPDU(wireDataBuffer, wireDataSize);
 		break;
 
+	case APDU_INSTRUCTION_DATUM_CHUNK_COMPRESSED:
+		handleDatumChunkCompressedAPDU(wireDataBuffer, wireDataSize);
+		break;
+
+	case APDU_INSTRUCTION_REF_SCRIPT_CHUNK_COMPRESSED:
+		handleRefScriptChunkCompressedAPDU(wireDataBuffer, wireDataSize);
+		break;
+
 	case APDU_INSTRUCTION_CONFIRM:
 		handleConfirmAPDU_output(wireDataBuffer, wireDataSize);
 		break;
@@ -1482,6 +1714,7 @@ bool signTxCollateralOutput_isValidInstruction(uint8_t p2)
 	case APDU_INSTRUCTION_DATUM_CHUNK:
 	case APDU_INSTRUCTION_REF_SCRIPT:
 	case APDU_INSTRUCTION_REF_SCRIPT_CHUNK:
+	case APDU_INSTRUCTION_TOKEN_BATCH:
 	case APDU_INSTRUCTION_CONFIRM:
 		return true;
 
@@ -1507,6 +1740,10 @@ void signTxCollateralOutput_handleAPDU(uint8_t p2, const uint8_t* wireDataBuffer
 		handleTokenAPDU(wireDataBuffer, wireDataSize);
 		break;
 
+	case APDU_INSTRUCTION_TOKEN_BATCH:
+		handleTokenBatchAPDU(wireDataBuffer, wireDataSize);
+		break;
+
 	case APDU_INSTRUCTION_CONFIRM:
 		handleConfirmAPDU_collateralOutput(wireDataBuffer, wireDataSize);
 		break;
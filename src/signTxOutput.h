@@ -6,6 +6,7 @@
 #include "addressUtilsShelley.h"
 #include "securityPolicyType.h"
 #include "txHashBuilder.h"
+#include "lzDecompressor.h"
 
 #define OUTPUT_ASSET_GROUPS_MAX UINT16_MAX
 #define OUTPUT_TOKENS_IN_GROUP_MAX UINT16_MAX
@@ -17,6 +18,9 @@
 // so it seems safe to set this to 240 B
 #define MAX_CHUNK_SIZE 240
 
+// only the beginning of inline datum / reference script is shown
+#define CHUNK_PREFIX_DISPLAY_SIZE 6
+
 
 // SIGN_STAGE_BODY_OUTPUTS = 25
 typedef enum {
@@ -66,6 +70,7 @@ typedef struct {
 			uint16_t currentAssetGroup;
 			uint16_t currentToken;
 			uint16_t numTokens;
+			bool isTokenBatch; // affects the response
 		};
 		struct {
 			// data for processing datum
@@ -79,14 +84,19 @@ typedef struct {
 					// inline datum
 					size_t datumRemainingBytes;
 					size_t datumChunkSize;
-					uint8_t datumChunk[MAX_CHUNK_SIZE];
+					// chunks are hashed directly from the wire, only the prefix is kept for the UI
+					uint8_t datumPrefix[CHUNK_PREFIX_DISPLAY_SIZE];
+					bool datumChunksCompressed;
+					lz_decompressor_t datumDecompressor;
 				};
 			};
 		};
 		struct {
 			size_t refScriptRemainingBytes;
 			size_t refScriptChunkSize;
-			uint8_t scriptChunk[MAX_CHUNK_SIZE];
+			uint8_t scriptPrefix[CHUNK_PREFIX_DISPLAY_SIZE];
+			bool refScriptChunksCompressed;
+			lz_decompressor_t refScriptDecompressor;
 		};
 	} stateData;
 
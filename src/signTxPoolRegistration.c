@@ -526,14 +526,16 @@ static void signTxPoolRegistration_handlePoolFinancialsAPDU(const uint8_t* wireD
 
 		TRACE_BUFFER(wireDataBuffer, wireDataSize);
 
-		struct {
+		typedef struct {
 			uint8_t pledge[8];
 			uint8_t cost[8];
 			uint8_t marginNumerator[8];
 			uint8_t marginDenominator[8];
-		}* wireHeader = (void*) wireDataBuffer;
+		} wire_pool_financials_t;
 
-		VALIDATE(wireDataSize == SIZEOF(*wireHeader), ERR_INVALID_DATA);
+		read_view_t view = make_read_view(wireDataBuffer, wireDataBuffer + wireDataSize);
+		const wire_pool_financials_t* wireHeader = view_parseRecord(&view, wire_pool_financials_t);
+		VALIDATE(view_remainingSize(&view) == 0, ERR_INVALID_DATA);
 
 		{
 			ASSERT_TYPE(subctx->stateData.pledge, uint64_t);
@@ -74,3 +74,43 @@ void view_parseDestination(read_view_t* view, tx_output_destination_storage_t* d
 		THROW(ERR_INVALID_DATA);
 	};
 }
+
+void view_parseDeltaCodedAssetName(
+        read_view_t* view,
+        uint8_t* assetNameBuffer, size_t* assetNameSize,
+        bool isFirstInGroup
+)
+{
+	ASSERT(*assetNameSize <= ASSET_NAME_SIZE_MAX);
+
+	const size_t sharedSize = parse_u1be(view);
+	const size_t suffixSize = parse_u1be(view);
+	TRACE("Asset name: shared prefix size %u, suffix size %u", sharedSize, suffixSize);
+	// there is nothing to share with for the first token
+	VALIDATE(sharedSize <= (isFirstInGroup ? 0 : *assetNameSize), ERR_INVALID_DATA);
+	VALIDATE(suffixSize <= ASSET_NAME_SIZE_MAX - sharedSize, ERR_INVALID_DATA);
+
+	uint8_t suffix[ASSET_NAME_SIZE_MAX] = {0};
+	view_parseBuffer(suffix, view, suffixSize);
+
+	if (!isFirstInGroup) {
+		// the shared prefix does not affect the ordering
+		VALIDATE(cbor_mapKeyFulfillsCanonicalOrdering(
+		                 assetNameBuffer + sharedSize, *assetNameSize - sharedSize,
+		                 suffix, suffixSize
+		         ), ERR_INVALID_DATA);
+	}
+
+	memmove(assetNameBuffer + sharedSize, suffix, suffixSize);
+	*assetNameSize = sharedSize + suffixSize;
+}
+
+void respondWithNumTokensProcessed(size_t numTokens)
+{
+	ASSERT(numTokens <= UINT8_MAX);
+
+	TRACE("Tokens processed: %u", numTokens);
+	uint8_t response = (uint8_t) numTokens;
+	io_send_buf(SUCCESS, &response, SIZEOF(response));
+	ui_displayBusy(); // displays dots, called only after I/O to avoid freezing
+}
@@ -18,4 +18,19 @@ bool violatesSingleAccountOrStoreIt(const bip44_path_t* path);
 
 void view_parseDestination(read_view_t* view, tx_output_destination_storage_t* destination);
 
+/**
+ * Parses an asset name of a token batch, given as the size of the prefix
+ * shared with the previous asset name in the token group and the rest of the name
+ *
+ * The previous name is overwritten, canonical ordering is checked on the way
+ */
+void view_parseDeltaCodedAssetName(
+        read_view_t* view,
+        uint8_t* assetNameBuffer, size_t* assetNameSize,
+        bool isFirstInGroup
+);
+
+// the response to a token batch
+void respondWithNumTokensProcessed(size_t numTokens);
+
 #endif  // H_CARDANO_APP_SIGN_TX_UTILS
@@ -0,0 +1,173 @@
+#include <os_io_seproxyhal.h>
+
+#include "softDerivation.h"
+#include "bip44.h"
+
+// size of an uncompressed point in the SDK format: 0x04 | x | y (big endian)
+#define POINT_SIZE 65
+
+// the base point of Ed25519
+static const uint8_t BASE_POINT[POINT_SIZE] = {
+	0x04, 0x21, 0x69, 0x36, 0xd3, 0xcd, 0x6e, 0x53,
+	0xfe, 0xc0, 0xa4, 0xe2, 0x31, 0xfd, 0xd6, 0xdc,
+	0x5c, 0x69, 0x2c, 0xc7, 0x60, 0x95, 0x25, 0xa7,
+	0xb2, 0xc9, 0x56, 0x2d, 0x60, 0x8f, 0x25, 0xd5,
+	0x1a, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66,
+	0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66,
+	0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66,
+	0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66,
+	0x58,
+};
+
+enum {
+	TAG_PUBLIC_KEY = 0x02,
+	TAG_CHAIN_CODE = 0x03,
+};
+
+static void _hmac(
+        const extendedPublicKey_t* parent,
+        uint8_t tag,
+        uint32_t index,
+        uint8_t* outBuffer, size_t outSize
+)
+{
+	ASSERT(outSize == 64);
+
+	uint8_t data[1 + PUBLIC_KEY_SIZE + 4] = {0};
+	data[0] = tag;
+	memmove(data + 1, parent->pubKey, PUBLIC_KEY_SIZE);
+	// little endian, unlike the rest of the app
+	for (size_t i = 0; i < 4; i++) {
+		data[1 + PUBLIC_KEY_SIZE + i] = (uint8_t) (index >> (8 * i));
+	}
+
+	cx_hmac_sha512(
+	        parent->chainCode, SIZEOF(parent->chainCode),
+	        data, SIZEOF(data),
+	        outBuffer, outSize
+	);
+}
+
+// the raw public key is the little endian y coordinate with the sign of x in the top bit,
+// the SDK expects 0x02 | big endian y (with the same sign bit)
+static void _decompressPublicKey(const uint8_t* pubKey, uint8_t* point)
+{
+	point[0] = 0x02;
+	for (size_t i = 0; i < PUBLIC_KEY_SIZE; i++) {
+		point[1 + i] = pubKey[PUBLIC_KEY_SIZE - 1 - i];
+	}
+	cx_edwards_decompress_point(CX_CURVE_Ed25519, point, POINT_SIZE);
+}
+
+void softDerivation_deriveChildPublicKey(
+        const extendedPublicKey_t* parent,
+        uint32_t index,
+        extendedPublicKey_t* child
+)
+{
+	// hardened children need the private key
+	ASSERT(!isHardened(index));
+	ASSERT(parent != child);
+
+	uint8_t z[64] = {0};
+	uint8_t scalar[32] = {0};
+	uint8_t point[POINT_SIZE] = {0};
+	uint8_t parentPoint[POINT_SIZE] = {0};
+
+	#ifndef FUZZING
+	io_seproxyhal_io_heartbeat();
+	#endif
+
+	{
+		_hmac(parent, TAG_PUBLIC_KEY, index, z, SIZEOF(z));
+
+		// 8 * Z[0:28] (little endian) as a big endian scalar for the SDK
+		unsigned carry = 0;
+		for (size_t i = 0; i < 28; i++) {
+			const unsigned value = ((unsigned) z[i] << 3) | carry;
+			scalar[SIZEOF(scalar) - 1 - i] = (uint8_t) value;
+			carry = value >> 8;
+		}
+		scalar[SIZEOF(scalar) - 1 - 28] = (uint8_t) carry;
+	}
+	{
+		STATIC_ASSERT(SIZEOF(point) == SIZEOF(BASE_POINT), "wrong point size");
+		memmove(point, BASE_POINT, SIZEOF(point));
+		cx_ecfp_scalar_mult(CX_CURVE_Ed25519, point, SIZEOF(point), scalar, SIZEOF(scalar));
+
+		_decompressPublicKey(parent->pubKey, parentPoint);
+
+		cx_ecfp_public_key_t publicKey;
+		publicKey.curve = CX_CURVE_Ed25519;
+		publicKey.W_len = POINT_SIZE;
+		STATIC_ASSERT(SIZEOF(publicKey.W) == POINT_SIZE, "wrong point size");
+		cx_ecfp_add_point(CX_CURVE_Ed25519, publicKey.W, parentPoint, point, POINT_SIZE);
+
+		extractRawPublicKey(&publicKey, child->pubKey, SIZEOF(child->pubKey));
+	}
+	{
+		_hmac(parent, TAG_CHAIN_CODE, index, z, SIZEOF(z));
+
+		STATIC_ASSERT(SIZEOF(child->chainCode) == 32, "wrong chain code size");
+		memmove(child->chainCode, z + 32, SIZEOF(child->chainCode));
+	}
+
+	#ifndef FUZZING
+	io_seproxyhal_io_heartbeat();
+	#endif
+}
+
+void softDerivation_deriveChildPrivateKey(
+        const privateKey_t* parentKey,
+        const extendedPublicKey_t* parentExtPubKey,
+        uint32_t index,
+        privateKey_t* childKey,
+        chain_code_t* childChainCode
+)
+{
+	ASSERT(!isHardened(index));
+	ASSERT(parentKey != childKey);
+	STATIC_ASSERT(SIZEOF(parentKey->d) == 64, "bad private key length");
+	ASSERT(parentKey->d_len == 64);
+
+	uint8_t z[64] = {0};
+
+	BEGIN_TRY {
+		TRY {
+			_hmac(parentExtPubKey, TAG_PUBLIC_KEY, index, z, SIZEOF(z));
+
+			explicit_bzero(childKey, SIZEOF(*childKey));
+			childKey->curve = CX_CURVE_Ed25519;
+			childKey->d_len = 64;
+
+			// kL' = 8 * Z[0:28] + kL (little endian)
+			unsigned shifted = 0; // the top bits of the previous byte of Z
+			unsigned carry = 0;
+			for (size_t i = 0; i < 32; i++) {
+				const unsigned zl = (i < 28) ? z[i] : 0;
+				const unsigned sum = parentKey->d[i] + (((zl << 3) | shifted) & 0xFF) + carry;
+				shifted = zl >> 5;
+				childKey->d[i] = (uint8_t) sum;
+				carry = sum >> 8;
+			}
+			// kL < 2^255 and 8 * Z[0:28] < 2^227, this takes millions of levels to overflow
+			ASSERT(shifted == 0 && carry == 0);
+
+			// kR' = Z[32:64] + kR mod 2^256 (little endian)
+			carry = 0;
+			for (size_t i = 32; i < 64; i++) {
+				const unsigned sum = parentKey->d[i] + z[i] + carry;
+				childKey->d[i] = (uint8_t) sum;
+				carry = sum >> 8;
+			}
+
+			_hmac(parentExtPubKey, TAG_CHAIN_CODE, index, z, SIZEOF(z));
+
+			STATIC_ASSERT(SIZEOF(childChainCode->code) == 32, "wrong chain code size");
+			memmove(childChainCode->code, z + 32, SIZEOF(childChainCode->code));
+		}
+		FINALLY {
+			explicit_bzero(z, SIZEOF(z));
+		}
+	} END_TRY;
+}
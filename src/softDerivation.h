@@ -0,0 +1,42 @@
+#ifndef H_CARDANO_APP_SOFT_DERIVATION
+#define H_CARDANO_APP_SOFT_DERIVATION
+
+#include "common.h"
+#include "keyDerivation.h"
+
+// Public (non-hardened) child key derivation of BIP32-Ed25519
+// (Khovratovich, Law: BIP32-Ed25519 Hierarchical Deterministic Keys over a Non-linear Keyspace)
+//
+// Z = HMAC-SHA512(chain code, 0x02 | public key | index)
+// child public key = public key + 8 * Z[0:28] * B
+// child chain code = HMAC-SHA512(chain code, 0x03 | public key | index)[32:64]
+//
+// with index serialized as 4 bytes little endian. Only public data are involved.
+
+void softDerivation_deriveChildPublicKey(
+        const extendedPublicKey_t* parent,
+        uint32_t index,
+        extendedPublicKey_t* child // output
+);
+
+// The private counterpart (with kL, kR the halves of the 64-byte private key):
+//
+// child kL = 8 * Z[0:28] + kL
+// child kR = Z[32:64] + kR mod 2^256
+//
+// The public key of the parent is needed for Z, the caller is expected to keep it
+// to avoid a scalar multiplication per child.
+void softDerivation_deriveChildPrivateKey(
+        const privateKey_t* parentKey,
+        const extendedPublicKey_t* parentExtPubKey,
+        uint32_t index,
+        privateKey_t* childKey, // output
+        chain_code_t* childChainCode // output
+);
+
+
+#ifdef DEVEL
+void run_softDerivation_test();
+#endif // DEVEL
+
+#endif // H_CARDANO_APP_SOFT_DERIVATION
@@ -0,0 +1,204 @@
+#ifdef DEVEL
+
+#include "softDerivation.h"
+#include "hexUtils.h"
+#include "testUtils.h"
+
+static void testcase_deriveChildPublicKey(
+        const char* parentHex,
+        uint32_t chain, uint32_t address,
+        const char* expectedHex
+)
+{
+	PRINTF("testcase_deriveChildPublicKey %s %u %u\n", parentHex, chain, address);
+
+	extendedPublicKey_t parent;
+	decode_hex(parentHex, (uint8_t*) &parent, SIZEOF(parent));
+
+	extendedPublicKey_t chainKey, child;
+	softDerivation_deriveChildPublicKey(&parent, chain, &chainKey);
+	softDerivation_deriveChildPublicKey(&chainKey, address, &child);
+
+	extendedPublicKey_t expected;
+	decode_hex(expectedHex, (uint8_t*) &expected, SIZEOF(expected));
+	EXPECT_EQ_BYTES(&child, &expected, SIZEOF(expected));
+}
+
+static void testChildPublicKeyDerivation()
+{
+	// public key and chain code of m/1852'/1815'/0' for the mnemonic below
+	const char* ACCOUNT_XPUB =
+	        "0d94fa4489745249e9cd999c907f2692e0e5c7ac868a960312ed5d480c59f2dc"
+	        "231adc1ee85703f714abe70c6d95f027e76ee947f361cbb72a155ac8cad6d23f";
+
+#define TESTCASE(chain_, address_, expectedHex_) \
+	testcase_deriveChildPublicKey(ACCOUNT_XPUB, chain_, address_, expectedHex_)
+
+	TESTCASE(
+	        0, 0,
+	        "cd2b047d1a803eee059769cffb3dfd0a4b9327e55bc78aa962d9bd4f720db0b2"
+	        "914ba07fb381f23c5c09bce26587bdf359aab7ea8f4192adbf93a38fd893ccea"
+	);
+	TESTCASE(
+	        1, 5,
+	        "38d791af73c1126283ead6dcc11e635b0748be2d57d61de4bb5d46ca7a00a7e5"
+	        "4fe59c768275d5c0c4c5541cd60803b7405c40d051ea81dcc0242cae016ec6c1"
+	);
+	TESTCASE(
+	        2, 0,
+	        "66610efd336e1137c525937b76511fbcf2a0e6bcf0d340a67bcb39bc870d85e8"
+	        "e977e956d29810dbfbda9c8ea667585982454e401c68578623d4b86bc7eb7b58"
+	);
+	TESTCASE(
+	        0, 1000000,
+	        "9c0f43da52067e2cc2dc49e7aee9b39a76e59bf0df78375dd5265a739fd7246c"
+	        "b3a9c29a031d81dcf4b254708532493004f56f44738636c056c603030ed278ee"
+	);
+#undef TESTCASE
+
+	EXPECT_THROWS(testcase_deriveChildPublicKey(ACCOUNT_XPUB, HARDENED_BIP32, 0, ""), ERR_ASSERT);
+}
+
+static void testConsistencyWithPrivateDerivation()
+{
+	PRINTF("testcase_softDerivation consistency\n");
+	// Note: needs the 12-word mnemonic 11*abandon about, see run_key_derivation_test
+	const uint32_t accountPath[] = {HARDENED_BIP32 + 1852, HARDENED_BIP32 + 1815, HARDENED_BIP32 + 0};
+	const uint32_t fullPath[] = {HARDENED_BIP32 + 1852, HARDENED_BIP32 + 1815, HARDENED_BIP32 + 0, 1, 42};
+
+	bip44_path_t pathSpec;
+	pathSpec.length = ARRAY_LEN(accountPath);
+	memmove(pathSpec.path, accountPath, SIZEOF(accountPath));
+	extendedPublicKey_t account;
+	deriveExtendedPublicKey(&pathSpec, &account);
+
+	pathSpec.length = ARRAY_LEN(fullPath);
+	memmove(pathSpec.path, fullPath, SIZEOF(fullPath));
+	extendedPublicKey_t expected;
+	deriveExtendedPublicKey(&pathSpec, &expected);
+
+	extendedPublicKey_t chainKey, child;
+	softDerivation_deriveChildPublicKey(&account, 1, &chainKey);
+	softDerivation_deriveChildPublicKey(&chainKey, 42, &child);
+	EXPECT_EQ_BYTES(&child, &expected, SIZEOF(expected));
+}
+
+static void testcase_deriveChildPrivateKey(
+        const char* parentKeyHex, const char* parentXpubHex,
+        uint32_t index,
+        const char* expectedKeyHex, const char* expectedChainCodeHex
+)
+{
+	PRINTF("testcase_deriveChildPrivateKey %u\n", index);
+
+	privateKey_t parentKey;
+	explicit_bzero(&parentKey, SIZEOF(parentKey));
+	parentKey.curve = CX_CURVE_Ed25519;
+	parentKey.d_len = 64;
+	decode_hex(parentKeyHex, parentKey.d, SIZEOF(parentKey.d));
+
+	extendedPublicKey_t parentExtPubKey;
+	decode_hex(parentXpubHex, (uint8_t*) &parentExtPubKey, SIZEOF(parentExtPubKey));
+
+	privateKey_t childKey;
+	chain_code_t childChainCode;
+	softDerivation_deriveChildPrivateKey(&parentKey, &parentExtPubKey, index, &childKey, &childChainCode);
+
+	uint8_t expected[64] = {0};
+	decode_hex(expectedKeyHex, expected, SIZEOF(expected));
+	EXPECT_EQ(childKey.d_len, 64);
+	EXPECT_EQ_BYTES(childKey.d, expected, SIZEOF(expected));
+
+	decode_hex(expectedChainCodeHex, expected, SIZEOF(childChainCode.code));
+	EXPECT_EQ_BYTES(childChainCode.code, expected, SIZEOF(childChainCode.code));
+}
+
+static void testChildPrivateKeyDerivation()
+{
+	// m/1852'/1815'/0' for the mnemonic below
+	const char* ACCOUNT_KEY =
+	        "8004724dd841dd1b978ee85f15a0a3e4d0ac89c4a1e4398177933e291ee69d41"
+	        "3506817168e4b5731e507124bdb31b12623068cc70032b2a4b0fdee9342b4ed6";
+	const char* ACCOUNT_XPUB =
+	        "0d94fa4489745249e9cd999c907f2692e0e5c7ac868a960312ed5d480c59f2dc"
+	        "231adc1ee85703f714abe70c6d95f027e76ee947f361cbb72a155ac8cad6d23f";
+	// m/1852'/1815'/0'/1
+	const char* CHAIN_KEY =
+	        "38ce0340a46be19a650915dce73e5bb32ddf942336d390a947f43a9423e69d41"
+	        "d62174262439b30aa557c520864253458a196ebed78ed7bd21c14ae48a744ba0";
+	const char* CHAIN_XPUB =
+	        "e1c14ac459540c848f21a6cce39d247ef72e89c6811ff3555a40813241b128ff"
+	        "708a1d61c84e12a5734dcf748d93bb486d8aa99579f8eebed0714ba89d8407be";
+
+	testcase_deriveChildPrivateKey(
+	        ACCOUNT_KEY, ACCOUNT_XPUB, 0,
+	        "600e6e09dfc6ddbd037fd73cea6795bda85b4a952b532ae9389e3e371ee69d41"
+	        "035944ea5c9a58dda6b0821679b8107ca1828f4a4d4f458df3c6675bbb29cee5",
+	        "0537334bdea6ad4e882cb1425d26a6e5b3fe95aee32adfbca88750d6b8c4f457"
+	);
+	testcase_deriveChildPrivateKey(
+	        ACCOUNT_KEY, ACCOUNT_XPUB, 1,
+	        CHAIN_KEY,
+	        "708a1d61c84e12a5734dcf748d93bb486d8aa99579f8eebed0714ba89d8407be"
+	);
+	testcase_deriveChildPrivateKey(
+	        CHAIN_KEY, CHAIN_XPUB, 42,
+	        "08c0e9e0ac9d4908613758ec615d2d3bffeb37a011295674ef5c304828e69d41"
+	        "f1017f0ed24efc96b4af417c2c04d341346bccaf515e9e5473f49b39e99a82ea",
+	        "7fd5b3e7a12aef1ed04a05d696111977e2f6fb90de8f58ca1b1163eda3cebca4"
+	);
+	testcase_deriveChildPrivateKey(
+	        CHAIN_KEY, CHAIN_XPUB, 1000000,
+	        "4086406dc5600f789666511d0121e5511a9b2a68cbe549d24404408628e69d41"
+	        "bd49cc70ea5a7cc972ffbecb857f4b4fd0c1c4955e9dcc87c2bcfba1f3881cf9",
+	        "b984fc34ecf316f50a207e4aab42ec08c5c3cbcd77333bc822f98f87a144b1a0"
+	);
+
+	EXPECT_THROWS(
+	        testcase_deriveChildPrivateKey(ACCOUNT_KEY, ACCOUNT_XPUB, HARDENED_BIP32, "", ""),
+	        ERR_ASSERT
+	);
+}
+
+static void testPrivateConsistencyWithSeedDerivation()
+{
+	PRINTF("testcase_softDerivation private consistency\n");
+	// Note: needs the 12-word mnemonic 11*abandon about, see run_key_derivation_test
+	const uint32_t accountPath[] = {HARDENED_BIP32 + 1852, HARDENED_BIP32 + 1815, HARDENED_BIP32 + 0};
+	const uint32_t fullPath[] = {HARDENED_BIP32 + 1852, HARDENED_BIP32 + 1815, HARDENED_BIP32 + 0, 1, 42};
+
+	bip44_path_t pathSpec;
+	pathSpec.length = ARRAY_LEN(accountPath);
+	memmove(pathSpec.path, accountPath, SIZEOF(accountPath));
+	privateKey_t accountKey;
+	chain_code_t chainCode;
+	derivePrivateKey(&pathSpec, &chainCode, &accountKey);
+	extendedPublicKey_t accountExtPubKey;
+	deriveExtendedPublicKey(&pathSpec, &accountExtPubKey);
+
+	pathSpec.length = ARRAY_LEN(fullPath);
+	memmove(pathSpec.path, fullPath, SIZEOF(fullPath));
+	privateKey_t expectedKey;
+	chain_code_t expectedChainCode;
+	derivePrivateKey(&pathSpec, &expectedChainCode, &expectedKey);
+
+	privateKey_t chainKey, childKey;
+	extendedPublicKey_t chainExtPubKey;
+	softDerivation_deriveChildPrivateKey(&accountKey, &accountExtPubKey, 1, &chainKey, &chainCode);
+	softDerivation_deriveChildPublicKey(&accountExtPubKey, 1, &chainExtPubKey);
+	EXPECT_EQ_BYTES(chainCode.code, chainExtPubKey.chainCode, SIZEOF(chainCode.code));
+
+	softDerivation_deriveChildPrivateKey(&chainKey, &chainExtPubKey, 42, &childKey, &chainCode);
+	EXPECT_EQ_BYTES(childKey.d, expectedKey.d, SIZEOF(expectedKey.d));
+	EXPECT_EQ_BYTES(chainCode.code, expectedChainCode.code, SIZEOF(expectedChainCode.code));
+}
+
+void run_softDerivation_test()
+{
+	testChildPublicKeyDerivation();
+	testConsistencyWithPrivateDerivation();
+	testChildPrivateKeyDerivation();
+	testPrivateConsistencyWithSeedDerivation();
+}
+
+#endif // DEVEL
@@ -2,3 +2,4 @@
 
 instructionState_t instructionState;
 int currentInstruction;
+int interruptedInstruction;
@@ -5,6 +5,7 @@
 #include "getPublicKeys.h"
 #include "deriveAddress.h"
 #include "deriveNativeScriptHash.h"
+#include "checkOwnership.h"
 #include "signTx.h"
 #include "signOpCert.h"
 #include "signCVote.h"
@@ -15,6 +16,7 @@ typedef union {
 	ins_get_keys_context_t getKeysContext;
 	ins_derive_address_context_t deriveAddressContext;
 	ins_derive_native_script_hash_context_t deriveNativeScriptHashContext;
+	ins_check_ownership_context_t checkOwnershipContext;
 	ins_sign_tx_context_t signTxContext;
 	ins_sign_op_cert_context_t signOpCertContext;
 	ins_sign_cvote_context_t signCVoteContext;
@@ -23,6 +25,10 @@ typedef union {
 // Note(instructions are uint8_t but we have a special INS_NONE value
 extern int currentInstruction;
 
+// an instruction interrupted by a transport reset while waiting for the next APDU,
+// its state is kept in case the host asks to resume it
+extern int interruptedInstruction;
+
 extern instructionState_t instructionState;
 
 #endif // H_CARDANO_APP_STATE
@@ -57,20 +57,55 @@ size_t deriveAssetFingerprintBech32(
 	return len;
 }
 
+/*
+ * The registry of known tokens is generated by tokenRegistry/convert.py.
+ *
+ * Tokens are sorted by fingerprint. The lookup bisects a dense array of fingerprint
+ * prefixes and confirms the match against the rest of the fingerprint in the token record.
+ * Tickers are concatenated (without terminators) into a single string addressed by offsets.
+ */
+
+#define TOKEN_FINGERPRINT_PREFIX_SIZE 4
+#define TOKEN_TICKER_LENGTH_MAX 15
+
+typedef struct {
+	uint8_t fingerprintSuffix[ASSET_FINGERPRINT_SIZE - TOKEN_FINGERPRINT_PREFIX_SIZE];
+	uint8_t tickerOffset[2]; // big endian, into tokenTickers
+	uint8_t decimalsAndTickerLength; // decimals in the upper nibble, ticker length in the lower one
+} token_record_t;
+
+#include "../tokenRegistry/token_data.c"
+
+STATIC_ASSERT(sizeof(token_record_t) == ASSET_FINGERPRINT_SIZE - TOKEN_FINGERPRINT_PREFIX_SIZE + 3, "padding in token record");
+STATIC_ASSERT(ARRAY_LEN(tokenFingerprintPrefixes) == ARRAY_LEN(tokenRecords), "inconsistent token registry");
+STATIC_ASSERT(sizeof(tokenTickers) <= 0xFFFF + 1, "ticker offsets do not fit");
+STATIC_ASSERT(TOKEN_TICKER_LENGTH_MAX == 0x0F, "ticker length is stored in a nibble");
+
 typedef struct {
-	uint8_t fingerprint[ASSET_FINGERPRINT_SIZE];
 	uint8_t decimals;
-	const char* ticker;
+	char ticker[TOKEN_TICKER_LENGTH_MAX + 1];
 } token_info_t;
 
-const token_info_t tokenInfos[] = {
-// a fixed list of most popular tokens
-#include "../tokenRegistry/token_data.c"
-};
+static int _compareFingerprint(size_t index, const uint8_t* fingerprint)
+{
+	ASSERT(index < ARRAY_LEN(tokenRecords));
 
-static const token_info_t* _getTokenInfo(
+	const int cmp = memcmp(tokenFingerprintPrefixes[index], fingerprint, TOKEN_FINGERPRINT_PREFIX_SIZE);
+	if (cmp != 0) {
+		return cmp;
+	}
+	return memcmp(
+	               tokenRecords[index].fingerprintSuffix,
+	               fingerprint + TOKEN_FINGERPRINT_PREFIX_SIZE,
+	               SIZEOF(tokenRecords[index].fingerprintSuffix)
+	       );
+}
+
+// returns false if the token is not in the registry
+static bool _getTokenInfo(
         const token_group_t* tokenGroup,
-        const uint8_t* assetNameBytes, size_t assetNameSize
+        const uint8_t* assetNameBytes, size_t assetNameSize,
+        token_info_t* tokenInfo
 )
 {
 	ASSERT(assetNameSize <= ASSET_NAME_SIZE_MAX);
@@ -82,14 +117,52 @@ static const token_info_t* _getTokenInfo(
 	        fingerprintBuffer, SIZEOF(fingerprintBuffer)
 	);
 
-	for (size_t i = 0; i < ARRAY_LEN(tokenInfos); i++) {
-		if (!memcmp(tokenInfos[i].fingerprint, fingerprintBuffer, ASSET_FINGERPRINT_SIZE)) {
-			return &tokenInfos[i];
+	// binary search in [low, high)
+	size_t low = 0;
+	size_t high = ARRAY_LEN(tokenRecords);
+	while (low < high) {
+		const size_t middle = low + (high - low) / 2;
+		const int cmp = _compareFingerprint(middle, fingerprintBuffer);
+		if (cmp == 0) {
+			const token_record_t* record = &tokenRecords[middle];
+			const size_t tickerOffset = u2be_read(record->tickerOffset);
+			const size_t tickerLength = record->decimalsAndTickerLength & 0x0F;
+			ASSERT(tickerOffset + tickerLength < sizeof(tokenTickers));
+
+			tokenInfo->decimals = record->decimalsAndTickerLength >> 4;
+			const char* tickers = (const char*) PIC(tokenTickers);
+			memmove(tokenInfo->ticker, tickers + tickerOffset, tickerLength);
+			tokenInfo->ticker[tickerLength] = '\0';
+			return true;
+		}
+		if (cmp < 0) {
+			low = middle + 1;
+		} else {
+			high = middle;
 		}
 	}
 
-	return NULL;
+	return false;
+}
+
+#ifdef DEVEL
+bool tokens_isTableSorted()
+{
+	for (size_t i = 1; i < ARRAY_LEN(tokenRecords); i++) {
+		uint8_t previous[ASSET_FINGERPRINT_SIZE];
+		memmove(previous, tokenFingerprintPrefixes[i - 1], TOKEN_FINGERPRINT_PREFIX_SIZE);
+		memmove(
+		        previous + TOKEN_FINGERPRINT_PREFIX_SIZE,
+		        tokenRecords[i - 1].fingerprintSuffix,
+		        SIZEOF(tokenRecords[i - 1].fingerprintSuffix)
+		);
+		if (_compareFingerprint(i, previous) <= 0) {
+			return false;
+		}
+	}
+	return true;
 }
+#endif // DEVEL
 
 size_t str_formatTokenAmountOutput(
         const token_group_t* tokenGroup,
@@ -101,12 +174,13 @@ size_t str_formatTokenAmountOutput(
 	ASSERT(assetNameSize <= ASSET_NAME_SIZE_MAX);
 	ASSERT(outSize < BUFFER_SIZE_PARANOIA);
 
-	const token_info_t* tokenInfo = _getTokenInfo(tokenGroup, assetNameBytes, assetNameSize);
-	int decimals = (tokenInfo != NULL) ? tokenInfo->decimals : 0;
+	token_info_t tokenInfo;
+	const bool isKnown = _getTokenInfo(tokenGroup, assetNameBytes, assetNameSize, &tokenInfo);
+	int decimals = isKnown ? tokenInfo.decimals : 0;
 	TRACE("token decimal places = %u", decimals);
 	size_t length = str_formatDecimalAmount(amount, decimals, out, outSize);
 
-	const char* ticker = (tokenInfo != NULL) ? PTR_PIC(tokenInfo->ticker) : "(unknown decimals)";
+	const char* ticker = isKnown ? tokenInfo.ticker : "(unknown decimals)";
 	TRACE("token ticker = %s", ticker);
 	snprintf(out + length, outSize - length, " %s", ticker);
 	length += 1 + strlen(ticker);
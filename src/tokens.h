@@ -31,6 +31,9 @@ size_t str_formatTokenAmountMint(
 );
 
 #ifdef DEVEL
+// the lookup relies on the order of the table generated by convert.py
+bool tokens_isTableSorted();
+
 void run_tokens_test();
 #endif // DEVEL
 
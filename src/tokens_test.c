@@ -82,6 +82,36 @@ const token_testcase_t tokenTestCases[] = {
 		-234,
 		"-0.00000234 REVU" // cspell:disable-line
 	},
+	{
+		// the first one in the table sorted by fingerprint
+		{ 0xd3, 0xa0, 0x34, 0xe4, 0x03, 0xb9, 0x8c, 0xbd, 0xb0, 0xad, 0xbc, 0x8a, 0x31, 0x44, 0xd7, 0x77, 0x93, 0x30, 0x91, 0x6e, 0x19, 0x0d, 0x38, 0x78, 0x15, 0xbb, 0x85, 0xc6 },
+		{ 0x50, 0x55, 0x52, 0x52 },
+		4,
+		1234,
+		"1,234 $PURR",
+		-1234,
+		"-1,234 $PURR"
+	},
+	{
+		// the in the middle one in the table sorted by fingerprint
+		{ 0xca, 0x94, 0x2c, 0xb8, 0xbb, 0x5d, 0x1e, 0xf7, 0x50, 0x76, 0x6d, 0xed, 0x35, 0x5f, 0x32, 0x08, 0x80, 0x53, 0x91, 0x11, 0xf1, 0x0e, 0xfa, 0x2b, 0x1a, 0x47, 0x8f, 0xf9 },
+		{ 0x52, 0x41, 0x47 },
+		3,
+		1234,
+		"1,234 RAG",
+		-1234,
+		"-1,234 RAG"
+	},
+	{
+		// the last one in the table sorted by fingerprint
+		{ 0x42, 0x47, 0xd5, 0x09, 0x1d, 0xb8, 0x23, 0x30, 0x10, 0x09, 0x04, 0x96, 0x3a, 0xb8, 0xd0, 0x85, 0x09, 0x76, 0xc8, 0x0d, 0x3f, 0x1b, 0x92, 0x7e, 0x05, 0x2e, 0x07, 0xbd },
+		{ 0x54, 0x6f, 0x6b, 0x68, 0x75, 0x6e },
+		6,
+		1234,
+		"1,234 Tokhun",
+		-1234,
+		"-1,234 Tokhun"
+	},
 	{
 		// no decimal places in our table
 		{ 0xaa, 0xcb, 0xb4, 0xfc, 0xbc, 0xaa, 0x29, 0x75, 0x77, 0x9f, 0x27, 0x3b, 0x26, 0x3e, 0xb3, 0xb5, 0xf2, 0x4a, 0x99, 0x51, 0xe4, 0x46, 0xd6, 0xdc, 0x4c, 0x13, 0x58, 0x64 },
@@ -119,10 +149,17 @@ void test_decimalPlaces()
 	}
 }
 
+void test_tokenInfosSorted()
+{
+	PRINTF("test_tokenInfosSorted\n");
+	EXPECT_EQ(tokens_isTableSorted(), true);
+}
+
 void run_tokens_test()
 {
 	test_assetFingerprint();
 	test_decimalPlaces();
+	test_tokenInfosSorted();
 }
 
 #endif
@@ -29,30 +29,126 @@ The following macros and functions have dual purpose:
 #define BUILDER_APPEND_DATA(buffer, bufferSize) \
 	blake2b_256_append_buffer_tx_body(&builder->txHash, buffer, bufferSize)
 
+// SIZEOF does not work for 4-byte buffers
+#define BUILDER_APPEND_TEMPLATE(template) \
+	BUILDER_APPEND_DATA(template, sizeof(template))
+
 
 static void blake2b_256_append_buffer_tx_body(
-        blake2b_256_context_t* hashCtx,
+        blake2b_256_buffered_context_t* hashCtx,
         const uint8_t* buffer, size_t bufferSize
 )
 {
 	TRACE_BUFFER(buffer, bufferSize);
-	blake2b_256_append(hashCtx, buffer, bufferSize);
+	blake2b_256_buffered_append(hashCtx, buffer, bufferSize);
 }
 
 __noinline_due_to_stack__
 static void blake2b_256_append_cbor_tx_body(
-        blake2b_256_context_t* hashCtx,
+        blake2b_256_buffered_context_t* hashCtx,
         uint8_t type, uint64_t value
 )
 {
 	uint8_t buffer[10] = {0};
 	size_t size = cbor_writeToken(type, value, buffer, SIZEOF(buffer));
 	TRACE_BUFFER(buffer, size);
-	blake2b_256_append(hashCtx, buffer, size);
+	blake2b_256_buffered_append(hashCtx, buffer, size);
 }
 
 /* End of hash computation utilities. */
 
+// pre-encoded fixed parts of tx body fragments, see TX_BODY_TEMPLATE_*
+static const uint8_t TEMPLATE_INPUT[] = {TX_BODY_TEMPLATE_INPUT};
+static const uint8_t TEMPLATE_CERTIFICATE_DELEGATION[] = {TX_BODY_TEMPLATE_CERTIFICATE_DELEGATION};
+static const uint8_t TEMPLATE_CERTIFICATE_POOL_RETIREMENT[] = {TX_BODY_TEMPLATE_CERTIFICATE_POOL_RETIREMENT};
+static const uint8_t TEMPLATE_CERTIFICATE_POOL_REGISTRATION[] = {TX_BODY_TEMPLATE_CERTIFICATE_POOL_REGISTRATION};
+static const uint8_t TEMPLATE_KEY_HASH[] = {TX_BODY_TEMPLATE_KEY_HASH};
+static const uint8_t TEMPLATE_POOL_KEY_HASH[] = {TX_BODY_TEMPLATE_POOL_KEY_HASH};
+static const uint8_t TEMPLATE_VRF_KEY_HASH[] = {TX_BODY_TEMPLATE_VRF_KEY_HASH};
+static const uint8_t TEMPLATE_POOL_MARGIN[] = {TX_BODY_TEMPLATE_POOL_MARGIN};
+static const uint8_t TEMPLATE_REWARD_ACCOUNT[] = {TX_BODY_TEMPLATE_REWARD_ACCOUNT};
+static const uint8_t TEMPLATE_POOL_METADATA_HASH[] = {TX_BODY_TEMPLATE_POOL_METADATA_HASH};
+static const uint8_t TEMPLATE_AUX_DATA[] = {TX_BODY_TEMPLATE_AUX_DATA};
+static const uint8_t TEMPLATE_SCRIPT_DATA_HASH[] = {TX_BODY_TEMPLATE_SCRIPT_DATA_HASH};
+static const uint8_t TEMPLATE_POLICY_ID[] = {TX_BODY_TEMPLATE_POLICY_ID};
+static const uint8_t TEMPLATE_DATUM_HASH[] = {TX_BODY_TEMPLATE_DATUM_HASH};
+static const uint8_t TEMPLATE_EMBEDDED_CBOR[] = {TX_BODY_TEMPLATE_EMBEDDED_CBOR};
+
+/*
+ * The items of the tx body map in the order of serialization (canonical by map keys):
+ * X(itemState, mapKey, isIncluded, assertCanLeave)
+ *   isIncluded     --- whether the item is a part of the tx body (given in txHashBuilder_init)
+ *   assertCanLeave --- checks that all contents of an entered item have been added
+ *
+ * The map header, the order of items and the transitions between them are derived from this table.
+ * A new tx body item only needs a row here and the functions adding its contents.
+ */
+#define TX_BODY_ITEMS(X) \
+	X(TX_HASH_BUILDER_IN_INPUTS, TX_BODY_KEY_INPUTS, \
+	  true, /* an array that is always included (even if empty) */ \
+	  ASSERT(builder->remainingInputs == 0)) \
+	X(TX_HASH_BUILDER_IN_OUTPUTS, TX_BODY_KEY_OUTPUTS, \
+	  true, /* an array that is always included (even if empty) */ \
+	  ASSERT(builder->remainingOutputs == 0); assertCanLeaveCurrentOutput(builder)) \
+	X(TX_HASH_BUILDER_IN_FEE, TX_BODY_KEY_FEE, \
+	  true, \
+	  /* nothing to check */) \
+	X(TX_HASH_BUILDER_IN_TTL, TX_BODY_KEY_TTL, \
+	  builder->includeTtl, \
+	  /* nothing to check */) \
+	X(TX_HASH_BUILDER_IN_CERTIFICATES, TX_BODY_KEY_CERTIFICATES, \
+	  builder->remainingCertificates > 0, \
+	  ASSERT(builder->remainingCertificates == 0)) \
+	X(TX_HASH_BUILDER_IN_WITHDRAWALS, TX_BODY_KEY_WITHDRAWALS, \
+	  builder->remainingWithdrawals > 0, \
+	  ASSERT(builder->remainingWithdrawals == 0)) \
+	X(TX_HASH_BUILDER_IN_AUX_DATA, TX_BODY_KEY_AUX_DATA, \
+	  builder->includeAuxData, \
+	  /* nothing to check */) \
+	X(TX_HASH_BUILDER_IN_VALIDITY_INTERVAL_START, TX_BODY_KEY_VALIDITY_INTERVAL_START, \
+	  builder->includeValidityIntervalStart, \
+	  /* nothing to check */) \
+	X(TX_HASH_BUILDER_IN_MINT, TX_BODY_KEY_MINT, \
+	  builder->includeMint, \
+	  ASSERT(builder->outputState == TX_OUTPUT_ASSET_GROUP); \
+	  ASSERT(builder->outputData.multiassetData.remainingAssetGroups == 0); \
+	  ASSERT(builder->outputData.multiassetData.remainingTokens == 0)) \
+	X(TX_HASH_BUILDER_IN_SCRIPT_DATA_HASH, TX_BODY_KEY_SCRIPT_HASH_DATA, \
+	  builder->includeScriptDataHash, \
+	  /* nothing to check */) \
+	X(TX_HASH_BUILDER_IN_COLLATERAL_INPUTS, TX_BODY_KEY_COLLATERAL_INPUTS, \
+	  builder->remainingCollateralInputs > 0, \
+	  ASSERT(builder->remainingCollateralInputs == 0)) \
+	X(TX_HASH_BUILDER_IN_REQUIRED_SIGNERS, TX_BODY_KEY_REQUIRED_SIGNERS, \
+	  builder->remainingRequiredSigners > 0, \
+	  ASSERT(builder->remainingRequiredSigners == 0)) \
+	X(TX_HASH_BUILDER_IN_NETWORK_ID, TX_BODY_KEY_NETWORK_ID, \
+	  builder->includeNetworkId, \
+	  /* nothing to check */) \
+	X(TX_HASH_BUILDER_IN_COLLATERAL_OUTPUT, TX_BODY_KEY_COLLATERAL_OUTPUT, \
+	  builder->includeCollateralOutput, \
+	  assertCanLeaveCurrentOutput(builder)) \
+	X(TX_HASH_BUILDER_IN_TOTAL_COLLATERAL, TX_BODY_KEY_TOTAL_COLLATERAL, \
+	  builder->includeTotalCollateral, \
+	  /* nothing to check */) \
+	X(TX_HASH_BUILDER_IN_REFERENCE_INPUTS, TX_BODY_KEY_REFERENCE_INPUTS, \
+	  builder->remainingReferenceInputs > 0, \
+	  ASSERT(builder->remainingReferenceInputs == 0))
+
+typedef struct {
+	uint16_t state; // tx_hash_builder_state_t
+	uint8_t mapKey;
+} tx_body_item_t;
+
+#define TX_BODY_ITEM(itemState, itemKey, isIncluded, assertCanLeave) \
+	{itemState, itemKey},
+
+static const tx_body_item_t TX_BODY_ITEM_LIST[] = {
+	TX_BODY_ITEMS(TX_BODY_ITEM)
+};
+
+#undef TX_BODY_ITEM
+
 static void cbor_append_txInput(
         tx_hash_builder_t* builder,
         const uint8_t* utxoHashBuffer, size_t utxoHashSize,
@@ -63,10 +159,9 @@ static void cbor_append_txInput(
 	//    Bytes[hash],
 	//    Unsigned[index]
 	// ]
-	BUILDER_APPEND_CBOR(CBOR_TYPE_ARRAY, 2);
+	ASSERT(utxoHashSize == TX_HASH_LENGTH);
+	BUILDER_APPEND_TEMPLATE(TEMPLATE_INPUT);
 	{
-		ASSERT(utxoHashSize == TX_HASH_LENGTH);
-		BUILDER_APPEND_CBOR(CBOR_TYPE_BYTES, utxoHashSize);
 		BUILDER_APPEND_DATA(utxoHashBuffer, utxoHashSize);
 	}
 	{
@@ -217,6 +312,80 @@ static void assertCanLeaveCurrentOutput(tx_hash_builder_t* builder)
 	}
 }
 
+// ============================== TX BODY ITEMS ==============================
+
+static bool txHashBuilder_isItemIncluded(tx_hash_builder_t* builder, tx_hash_builder_state_t itemState)
+{
+	switch (itemState) {
+
+#define TX_BODY_ITEM(itemState, itemKey, isIncluded, assertCanLeave) \
+	case itemState: \
+		return (isIncluded);
+
+		TX_BODY_ITEMS(TX_BODY_ITEM)
+
+#undef TX_BODY_ITEM
+
+	default:
+		ASSERT(false);
+		return false;
+	}
+}
+
+static void txHashBuilder_assertCanLeaveItem(tx_hash_builder_t* builder, tx_hash_builder_state_t itemState)
+{
+	switch (itemState) {
+
+#define TX_BODY_ITEM(itemState, itemKey, isIncluded, assertCanLeave) \
+	case itemState: \
+		assertCanLeave; \
+		break;
+
+		TX_BODY_ITEMS(TX_BODY_ITEM)
+
+#undef TX_BODY_ITEM
+
+	default:
+		ASSERT(false);
+	}
+}
+
+// each item preceding the given one was either completely added or is not included at all
+static void txHashBuilder_assertCanLeavePrecedingItems(tx_hash_builder_t* builder, size_t itemIndex)
+{
+	_TRACE("state = %d, itemIndex = %u", builder->state, itemIndex);
+
+	ASSERT(itemIndex <= ARRAY_LEN(TX_BODY_ITEM_LIST));
+
+	for (size_t i = itemIndex; i > 0; i--) {
+		const tx_hash_builder_state_t itemState = (tx_hash_builder_state_t) TX_BODY_ITEM_LIST[i - 1].state;
+		if (builder->state == itemState) {
+			txHashBuilder_assertCanLeaveItem(builder, itemState);
+			return;
+		}
+		// make sure the skipped item was not expected
+		ASSERT(!txHashBuilder_isItemIncluded(builder, itemState));
+	}
+	ASSERT(builder->state == TX_HASH_BUILDER_INIT);
+}
+
+// appends the map key of the item, its contents are added by the caller
+static void txHashBuilder_enterItem(tx_hash_builder_t* builder, tx_hash_builder_state_t itemState)
+{
+	size_t itemIndex = 0;
+	while ((itemIndex < ARRAY_LEN(TX_BODY_ITEM_LIST)) && (TX_BODY_ITEM_LIST[itemIndex].state != itemState)) {
+		itemIndex++;
+	}
+	ASSERT(itemIndex < ARRAY_LEN(TX_BODY_ITEM_LIST));
+
+	txHashBuilder_assertCanLeavePrecedingItems(builder, itemIndex);
+	// we don't allow an empty list for an optional item
+	ASSERT(txHashBuilder_isItemIncluded(builder, itemState));
+
+	BUILDER_APPEND_CBOR(CBOR_TYPE_UNSIGNED, TX_BODY_ITEM_LIST[itemIndex].mapKey);
+	builder->state = itemState;
+}
+
 // ============================== TX HASH BUILDER STATE INITIALIZATION ==============================
 
 void txHashBuilder_init(
@@ -254,60 +423,33 @@ void txHashBuilder_init(
 	TRACE("includeTotalCollateral = %u", includeTotalCollateral);
 	TRACE("numReferenceInputs = %u", numReferenceInputs);
 
-	blake2b_256_init(&builder->txHash);
+	blake2b_256_buffered_init(&builder->txHash);
+
+	builder->remainingInputs = numInputs;
+	builder->remainingOutputs = numOutputs;
+	builder->includeTtl = includeTtl;
+	builder->remainingCertificates = numCertificates;
+	builder->remainingWithdrawals = numWithdrawals;
+	builder->includeAuxData = includeAuxData;
+	builder->includeValidityIntervalStart = includeValidityIntervalStart;
+	builder->includeMint = includeMint;
+	builder->includeScriptDataHash = includeScriptDataHash;
+	builder->remainingCollateralInputs = numCollateralInputs;
+	builder->remainingRequiredSigners = numRequiredSigners;
+	builder->includeNetworkId = includeNetworkId;
+	builder->includeCollateralOutput = includeCollateralOutput;
+	builder->includeTotalCollateral = includeTotalCollateral;
+	builder->remainingReferenceInputs = numReferenceInputs;
 
 	{
 		size_t numItems = 0;
-
-		builder->remainingInputs = numInputs;
-		numItems++; // an array that is always included (even if empty)
-
-		builder->remainingOutputs = numOutputs;
-		numItems++; // an array that is always included (even if empty)
-
-		// fee always included
-		numItems++;
-
-		builder->includeTtl = includeTtl;
-		if (includeTtl) numItems++;
-
-		builder->remainingCertificates = numCertificates;
-		if (numCertificates > 0) numItems++;
-
-		builder->remainingWithdrawals = numWithdrawals;
-		if (numWithdrawals > 0) numItems++;
-
-		builder->includeAuxData = includeAuxData;
-		if (includeAuxData) numItems++;
-
-		builder->includeValidityIntervalStart = includeValidityIntervalStart;
-		if (includeValidityIntervalStart) numItems++;
-
-		builder->includeMint = includeMint;
-		if (includeMint) numItems++;
-
-		builder->includeScriptDataHash = includeScriptDataHash;
-		if (includeScriptDataHash) numItems++;
-
-		builder->remainingCollateralInputs = numCollateralInputs;
-		if (numCollateralInputs > 0) numItems++;
-
-		builder->remainingRequiredSigners = numRequiredSigners;
-		if (numRequiredSigners > 0) numItems++;
-
-		builder->includeNetworkId = includeNetworkId;
-		if (includeNetworkId) numItems++;
-
-		builder->includeCollateralOutput = includeCollateralOutput;
-		if (includeCollateralOutput) numItems++;
-
-		builder->includeTotalCollateral = includeTotalCollateral;
-		if (includeTotalCollateral) numItems++;
-
-		builder->remainingReferenceInputs = numReferenceInputs;
-		if (numReferenceInputs > 0) numItems++;
-
-		ASSERT((3 <= numItems) && (numItems <= 16));
+		for (size_t i = 0; i < ARRAY_LEN(TX_BODY_ITEM_LIST); i++) {
+			if (txHashBuilder_isItemIncluded(builder, (tx_hash_builder_state_t) TX_BODY_ITEM_LIST[i].state)) {
+				numItems++;
+			}
+		}
+		// inputs, outputs and fee are always included
+		ASSERT((3 <= numItems) && (numItems <= ARRAY_LEN(TX_BODY_ITEM_LIST)));
 
 		_TRACE("Serializing tx body with %u items", numItems);
 		BUILDER_APPEND_CBOR(CBOR_TYPE_MAP, numItems);
@@ -315,26 +457,14 @@ void txHashBuilder_init(
 	builder->state = TX_HASH_BUILDER_INIT;
 }
 
-static void txHashBuilder_assertCanLeaveInit(tx_hash_builder_t* builder)
-{
-	_TRACE("state = %d", builder->state);
-
-	ASSERT(builder->state == TX_HASH_BUILDER_INIT);
-}
-
 // ============================== INPUTS ==============================
 
 void txHashBuilder_enterInputs(tx_hash_builder_t* builder)
 {
 	_TRACE("state = %d", builder->state);
 
-	txHashBuilder_assertCanLeaveInit(builder);
-	{
-		// Enter inputs
-		BUILDER_APPEND_CBOR(CBOR_TYPE_UNSIGNED, TX_BODY_KEY_INPUTS);
-		BUILDER_APPEND_CBOR(CBOR_TYPE_ARRAY, builder->remainingInputs);
-	}
-	builder->state = TX_HASH_BUILDER_IN_INPUTS;
+	txHashBuilder_enterItem(builder, TX_HASH_BUILDER_IN_INPUTS);
+	BUILDER_APPEND_CBOR(CBOR_TYPE_ARRAY, builder->remainingInputs);
 }
 
 void txHashBuilder_addInput(tx_hash_builder_t* builder, const tx_input_t* input)
@@ -350,27 +480,15 @@ void txHashBuilder_addInput(tx_hash_builder_t* builder, const tx_input_t* input)
 	cbor_append_txInput(builder, input->txHashBuffer, utxoHashSize, input->index);
 }
 
-static void txHashBuilder_assertCanLeaveInputs(tx_hash_builder_t* builder)
-{
-	_TRACE("state = %d, remainingInputs = %u", builder->state, builder->remainingInputs);
-
-	ASSERT(builder->state == TX_HASH_BUILDER_IN_INPUTS);
-	ASSERT(builder->remainingInputs == 0);
-}
-
 // ============================== OUTPUTS ==============================
 
 void txHashBuilder_enterOutputs(tx_hash_builder_t* builder)
 {
 	_TRACE("state = %d", builder->state);
 
-	txHashBuilder_assertCanLeaveInputs(builder);
-	{
-		// Enter outputs
-		BUILDER_APPEND_CBOR(CBOR_TYPE_UNSIGNED, TX_BODY_KEY_OUTPUTS);
-		BUILDER_APPEND_CBOR(CBOR_TYPE_ARRAY, builder->remainingOutputs);
-	}
-	builder->state = TX_HASH_BUILDER_IN_OUTPUTS;
+	txHashBuilder_enterItem(builder, TX_HASH_BUILDER_IN_OUTPUTS);
+	BUILDER_APPEND_CBOR(CBOR_TYPE_ARRAY, builder->remainingOutputs);
+
 	builder->outputState = TX_OUTPUT_INIT;
 }
 
@@ -435,7 +553,7 @@ static void addTokenGroup(
 		//   // entries added later { * asset_name => uint }
 		// ]
 		{
-			BUILDER_APPEND_CBOR(CBOR_TYPE_BYTES, policyIdSize);
+			BUILDER_APPEND_TEMPLATE(TEMPLATE_POLICY_ID);
 			BUILDER_APPEND_DATA(policyIdBuffer, policyIdSize);
 		}
 		{
@@ -562,7 +680,7 @@ void txHashBuilder_addOutput_datum(
 		ASSERT(bufferSize == OUTPUT_DATUM_HASH_LENGTH);
 		builder->outputData.datumData.remainingBytes = bufferSize;
 		{
-			BUILDER_APPEND_CBOR(CBOR_TYPE_BYTES, bufferSize);
+			BUILDER_APPEND_TEMPLATE(TEMPLATE_DATUM_HASH);
 			BUILDER_APPEND_DATA(buffer, bufferSize);
 		}
 		//  Hash is transmitted in one chunk, and datumType stage is finished
@@ -576,7 +694,7 @@ void txHashBuilder_addOutput_datum(
 		// bufferSize is total size of datum
 		builder->outputData.datumData.remainingBytes = bufferSize;
 		{
-			BUILDER_APPEND_CBOR(CBOR_TYPE_TAG, CBOR_TAG_EMBEDDED_CBOR_BYTE_STRING);
+			BUILDER_APPEND_TEMPLATE(TEMPLATE_EMBEDDED_CBOR);
 			BUILDER_APPEND_CBOR(CBOR_TYPE_BYTES, bufferSize);
 			// byte chunks will be added later
 		}
@@ -638,7 +756,7 @@ void txHashBuilder_addOutput_referenceScript(tx_hash_builder_t* builder, size_t
 		BUILDER_APPEND_CBOR(CBOR_TYPE_UNSIGNED, TX_OUTPUT_KEY_SCRIPT_REF);
 	}
 	{
-		BUILDER_APPEND_CBOR(CBOR_TYPE_TAG, CBOR_TAG_EMBEDDED_CBOR_BYTE_STRING);
+		BUILDER_APPEND_TEMPLATE(TEMPLATE_EMBEDDED_CBOR);
 		BUILDER_APPEND_CBOR(CBOR_TYPE_BYTES, scriptSize);
 		// byte chunks will be added later
 	}
@@ -659,37 +777,14 @@ void txHashBuilder_addOutput_referenceScript_dataChunk(
 	builder->outputData.referenceScriptData.remainingBytes -= bufferSize;
 }
 
-static void txHashBuilder_assertCanLeaveOutputs(tx_hash_builder_t* builder)
-{
-	_TRACE("state = %d, remainingOutputs = %u", builder->state, builder->remainingOutputs);
-
-	// we need to check this first to make sure the subsequent checks are meaningful
-	ASSERT(builder->state == TX_HASH_BUILDER_IN_OUTPUTS);
-	ASSERT(builder->remainingOutputs == 0);
-
-	assertCanLeaveCurrentOutput(builder);
-}
-
 // ============================== FEE ==============================
 
 void txHashBuilder_addFee(tx_hash_builder_t* builder, uint64_t fee)
 {
 	_TRACE("state = %d", builder->state);
 
-	txHashBuilder_assertCanLeaveOutputs(builder);
-
-	// add fee item into the main tx body map
-	BUILDER_APPEND_CBOR(CBOR_TYPE_UNSIGNED, TX_BODY_KEY_FEE);
+	txHashBuilder_enterItem(builder, TX_HASH_BUILDER_IN_FEE);
 	BUILDER_APPEND_CBOR(CBOR_TYPE_UNSIGNED, fee);
-
-	builder->state = TX_HASH_BUILDER_IN_FEE;
-}
-
-static void txHashBuilder_assertCanLeaveFee(tx_hash_builder_t* builder)
-{
-	_TRACE("state = %d", builder->state);
-
-	ASSERT(builder->state == TX_HASH_BUILDER_IN_FEE);
 }
 
 // ============================== TTL ==============================
@@ -698,31 +793,8 @@ void txHashBuilder_addTtl(tx_hash_builder_t* builder, uint64_t ttl)
 {
 	_TRACE("state = %d", builder->state);
 
-	txHashBuilder_assertCanLeaveFee(builder);
-	ASSERT(builder->includeTtl);
-
-	BUILDER_APPEND_CBOR(CBOR_TYPE_UNSIGNED, TX_BODY_KEY_TTL);
+	txHashBuilder_enterItem(builder, TX_HASH_BUILDER_IN_TTL);
 	BUILDER_APPEND_CBOR(CBOR_TYPE_UNSIGNED, ttl);
-
-	builder->state = TX_HASH_BUILDER_IN_TTL;
-}
-
-static void txHashBuilder_assertCanLeaveTtl(tx_hash_builder_t* builder)
-{
-	_TRACE("state = %d", builder->state);
-
-	switch (builder->state) {
-	case TX_HASH_BUILDER_IN_TTL:
-		// TTL was added, we can move on
-		break;
-
-	default:
-		// make sure TTL was not expected
-		ASSERT(!builder->includeTtl);
-		// assert we can leave the previous state
-		txHashBuilder_assertCanLeaveFee(builder);
-		break;
-	}
 }
 
 // ============================== CERTIFICATES ==============================
@@ -731,19 +803,11 @@ void txHashBuilder_enterCertificates(tx_hash_builder_t* builder)
 {
 	_TRACE("state = %d, remaining certificates = %u", builder->state, builder->remainingCertificates);
 
-	txHashBuilder_assertCanLeaveTtl(builder);
-	ASSERT(builder->remainingCertificates > 0);
-
-	{
-		// Enter certificates
-		BUILDER_APPEND_CBOR(CBOR_TYPE_UNSIGNED, TX_BODY_KEY_CERTIFICATES);
-		BUILDER_APPEND_CBOR(CBOR_TYPE_ARRAY, builder->remainingCertificates);
-	}
+	txHashBuilder_enterItem(builder, TX_HASH_BUILDER_IN_CERTIFICATES);
+	BUILDER_APPEND_CBOR(CBOR_TYPE_ARRAY, builder->remainingCertificates);
 
 	builder->poolCertificateData.remainingOwners = 0;
 	builder->poolCertificateData.remainingRelays = 0;
-
-	builder->state = TX_HASH_BUILDER_IN_CERTIFICATES;
 }
 
 static uint32_t getStakeCredentialSource(const stake_credential_type_t stakeCredentialType)
@@ -801,7 +865,7 @@ void txHashBuilder_addCertificate_stakingHash(
 				BUILDER_APPEND_CBOR(CBOR_TYPE_UNSIGNED, getStakeCredentialSource(stakeCredentialType));
 			}
 			{
-				BUILDER_APPEND_CBOR(CBOR_TYPE_BYTES, stakingHashSize);
+				BUILDER_APPEND_TEMPLATE(TEMPLATE_KEY_HASH);
 				BUILDER_APPEND_DATA(stakingHash, stakingHashSize);
 			}
 		}
@@ -833,22 +897,18 @@ void txHashBuilder_addCertificate_delegation(
 	//   Bytes[poolKeyHash]
 	// ]
 	{
-		BUILDER_APPEND_CBOR(CBOR_TYPE_ARRAY, 3);
-		{
-			BUILDER_APPEND_CBOR(CBOR_TYPE_UNSIGNED, 2);
-		}
+		BUILDER_APPEND_TEMPLATE(TEMPLATE_CERTIFICATE_DELEGATION);
 		{
-			BUILDER_APPEND_CBOR(CBOR_TYPE_ARRAY, 2);
 			{
 				BUILDER_APPEND_CBOR(CBOR_TYPE_UNSIGNED, getStakeCredentialSource(stakeCredentialType));
 			}
 			{
-				BUILDER_APPEND_CBOR(CBOR_TYPE_BYTES, stakingKeyHashSize);
+				BUILDER_APPEND_TEMPLATE(TEMPLATE_KEY_HASH);
 				BUILDER_APPEND_DATA(stakingKeyHash, stakingKeyHashSize);
 			}
 		}
 		{
-			BUILDER_APPEND_CBOR(CBOR_TYPE_BYTES, poolKeyHashSize);
+			BUILDER_APPEND_TEMPLATE(TEMPLATE_POOL_KEY_HASH);
 			BUILDER_APPEND_DATA(poolKeyHash, poolKeyHashSize);
 		}
 	}
@@ -874,12 +934,8 @@ void txHashBuilder_addCertificate_poolRetirement(
 	//   Unsigned[epoch]
 	// ]
 	{
-		BUILDER_APPEND_CBOR(CBOR_TYPE_ARRAY, 3);
+		BUILDER_APPEND_TEMPLATE(TEMPLATE_CERTIFICATE_POOL_RETIREMENT);
 		{
-			BUILDER_APPEND_CBOR(CBOR_TYPE_UNSIGNED, 4);
-		}
-		{
-			BUILDER_APPEND_CBOR(CBOR_TYPE_BYTES, poolKeyHashSize);
 			BUILDER_APPEND_DATA(poolKeyHash, poolKeyHashSize);
 		}
 		BUILDER_APPEND_CBOR(CBOR_TYPE_UNSIGNED, epoch);
@@ -905,12 +961,7 @@ void txHashBuilder_poolRegistrationCertificate_enter(
 	// Array(10)[
 	//   Unsigned[3]
 
-	{
-		BUILDER_APPEND_CBOR(CBOR_TYPE_ARRAY, 10);
-		{
-			BUILDER_APPEND_CBOR(CBOR_TYPE_UNSIGNED, 3);
-		}
-	}
+	BUILDER_APPEND_TEMPLATE(TEMPLATE_CERTIFICATE_POOL_REGISTRATION);
 
 	builder->state = TX_HASH_BUILDER_IN_CERTIFICATES_POOL_INIT;
 }
@@ -928,7 +979,7 @@ void txHashBuilder_poolRegistrationCertificate_poolKeyHash(
 
 	//   Bytes[pool_keyhash]          // also called operator in CDDL specs and pool id in user interfaces
 	{
-		BUILDER_APPEND_CBOR(CBOR_TYPE_BYTES, poolKeyHashSize);
+		BUILDER_APPEND_TEMPLATE(TEMPLATE_POOL_KEY_HASH);
 		BUILDER_APPEND_DATA(poolKeyHash, poolKeyHashSize);
 	}
 
@@ -948,7 +999,7 @@ void txHashBuilder_poolRegistrationCertificate_vrfKeyHash(
 
 	//   Bytes[vrf_keyhash]
 	{
-		BUILDER_APPEND_CBOR(CBOR_TYPE_BYTES, vrfKeyHashSize);
+		BUILDER_APPEND_TEMPLATE(TEMPLATE_VRF_KEY_HASH);
 		BUILDER_APPEND_DATA(vrfKeyHash, vrfKeyHashSize);
 	}
 
@@ -979,8 +1030,7 @@ void txHashBuilder_poolRegistrationCertificate_financials(
 			BUILDER_APPEND_CBOR(CBOR_TYPE_UNSIGNED, cost);
 		}
 		{
-			BUILDER_APPEND_CBOR(CBOR_TYPE_TAG, 30);
-			BUILDER_APPEND_CBOR(CBOR_TYPE_ARRAY, 2);
+			BUILDER_APPEND_TEMPLATE(TEMPLATE_POOL_MARGIN);
 			{
 				BUILDER_APPEND_CBOR(CBOR_TYPE_UNSIGNED, marginNumerator);
 			}
@@ -1006,7 +1056,7 @@ void txHashBuilder_poolRegistrationCertificate_rewardAccount(
 
 	//   Bytes[rewardAccount]
 	{
-		BUILDER_APPEND_CBOR(CBOR_TYPE_BYTES, rewardAccountSize);
+		BUILDER_APPEND_TEMPLATE(TEMPLATE_REWARD_ACCOUNT);
 		BUILDER_APPEND_DATA(rewardAccount, rewardAccountSize);
 	}
 
@@ -1041,7 +1091,7 @@ void txHashBuilder_addPoolRegistrationCertificate_addOwner(
 
 	// Bytes[poolKeyHash]
 	{
-		BUILDER_APPEND_CBOR(CBOR_TYPE_BYTES, stakingKeyHashSize);
+		BUILDER_APPEND_TEMPLATE(TEMPLATE_KEY_HASH);
 		BUILDER_APPEND_DATA(stakingKeyHash, stakingKeyHashSize);
 	}
 }
@@ -1261,7 +1311,7 @@ void txHashBuilder_addPoolRegistrationCertificate_addPoolMetadata(
 			BUILDER_APPEND_DATA(url, urlSize);
 		}
 		{
-			BUILDER_APPEND_CBOR(CBOR_TYPE_BYTES, metadataHashSize);
+			BUILDER_APPEND_TEMPLATE(TEMPLATE_POOL_METADATA_HASH);
 			BUILDER_APPEND_DATA(metadataHash, metadataHashSize);
 		}
 	}
@@ -1282,41 +1332,14 @@ void txHashBuilder_addPoolRegistrationCertificate_addPoolMetadata_null(
 	builder->state = TX_HASH_BUILDER_IN_CERTIFICATES;
 }
 
-static void txHashBuilder_assertCanLeaveCertificates(tx_hash_builder_t* builder)
-{
-	_TRACE("state = %d, remainingCertificates = %u", builder->state, builder->remainingCertificates);
-
-	switch (builder->state) {
-	case TX_HASH_BUILDER_IN_CERTIFICATES:
-		// make sure there are not remaining certificates to process
-		ASSERT(builder->remainingCertificates == 0);
-		break;
-
-	default:
-		// make sure no certificates are expected
-		ASSERT(builder->remainingCertificates == 0);
-		// assert we can leave the previous state
-		txHashBuilder_assertCanLeaveTtl(builder);
-		break;
-	}
-}
-
 // ============================== WITHDRAWALS ==============================
 
 void txHashBuilder_enterWithdrawals(tx_hash_builder_t* builder)
 {
 	_TRACE("state = %d, remainingWithdrawals = %u", builder->state, builder->remainingWithdrawals);
 
-	txHashBuilder_assertCanLeaveCertificates(builder);
-	ASSERT(builder->remainingWithdrawals > 0);
-
-	{
-		// enter withdrawals
-		BUILDER_APPEND_CBOR(CBOR_TYPE_UNSIGNED, TX_BODY_KEY_WITHDRAWALS);
-		BUILDER_APPEND_CBOR(CBOR_TYPE_MAP, builder->remainingWithdrawals);
-	}
-
-	builder->state = TX_HASH_BUILDER_IN_WITHDRAWALS;
+	txHashBuilder_enterItem(builder, TX_HASH_BUILDER_IN_WITHDRAWALS);
+	BUILDER_APPEND_CBOR(CBOR_TYPE_MAP, builder->remainingWithdrawals);
 }
 
 void txHashBuilder_addWithdrawal(
@@ -1337,7 +1360,7 @@ void txHashBuilder_addWithdrawal(
 	//   Bytes[address]
 	//   Unsigned[amount]
 	{
-		BUILDER_APPEND_CBOR(CBOR_TYPE_BYTES, rewardAddressSize);
+		BUILDER_APPEND_TEMPLATE(TEMPLATE_REWARD_ACCOUNT);
 		BUILDER_APPEND_DATA(rewardAddressBuffer, rewardAddressSize);
 	}
 	{
@@ -1345,59 +1368,19 @@ void txHashBuilder_addWithdrawal(
 	}
 }
 
-static void txHashBuilder_assertCanLeaveWithdrawals(tx_hash_builder_t* builder)
-{
-	_TRACE("state = %d, remainingWithdrawals = %u", builder->state, builder->remainingWithdrawals);
-
-	switch (builder->state) {
-	case TX_HASH_BUILDER_IN_WITHDRAWALS:
-		// make sure there are no more withdrawals to process
-		ASSERT(builder->remainingWithdrawals == 0);
-		break;
-
-	default:
-		// make sure no withdrawals are expected
-		ASSERT(builder->remainingWithdrawals == 0);
-		// assert we can leave the previous state
-		txHashBuilder_assertCanLeaveCertificates(builder);
-		break;
-	}
-}
-
 // ============================== AUXILIARY DATA ==============================
 
 void txHashBuilder_addAuxData(tx_hash_builder_t* builder, const uint8_t* auxDataHashBuffer, size_t auxDataHashBufferSize)
 {
 	_TRACE("state = %d, remainingWithdrawals = %u", builder->state, builder->remainingWithdrawals);
 
-	txHashBuilder_assertCanLeaveWithdrawals(builder);
-	ASSERT(builder->includeAuxData);
-
 	ASSERT(auxDataHashBufferSize == AUX_DATA_HASH_LENGTH);
+
+	txHashBuilder_enterItem(builder, TX_HASH_BUILDER_IN_AUX_DATA);
 	{
-		BUILDER_APPEND_CBOR(CBOR_TYPE_UNSIGNED, TX_BODY_KEY_AUX_DATA);
-		BUILDER_APPEND_CBOR(CBOR_TYPE_BYTES, auxDataHashBufferSize);
+		BUILDER_APPEND_TEMPLATE(TEMPLATE_AUX_DATA);
 		BUILDER_APPEND_DATA(auxDataHashBuffer, auxDataHashBufferSize);
 	}
-	builder->state = TX_HASH_BUILDER_IN_AUX_DATA;
-}
-
-static void txHashBuilder_assertCanLeaveAuxData(tx_hash_builder_t* builder)
-{
-	_TRACE("state = %d", builder->state);
-
-	switch (builder->state) {
-	case TX_HASH_BUILDER_IN_AUX_DATA:
-		// aux data was added, we can move on
-		break;
-
-	default:
-		// make sure aux data was not expected
-		ASSERT(!builder->includeAuxData);
-		// assert we can leave the previous state
-		txHashBuilder_assertCanLeaveWithdrawals(builder);
-		break;
-	}
 }
 
 // ============================== VALIDITY INTERVAL START ==============================
@@ -1406,32 +1389,8 @@ void txHashBuilder_addValidityIntervalStart(tx_hash_builder_t* builder, uint64_t
 {
 	_TRACE("state = %d", builder->state);
 
-	txHashBuilder_assertCanLeaveAuxData(builder);
-	ASSERT(builder->includeValidityIntervalStart);
-
-	// add validity interval start item into the main tx body map
-	BUILDER_APPEND_CBOR(CBOR_TYPE_UNSIGNED, TX_BODY_KEY_VALIDITY_INTERVAL_START);
+	txHashBuilder_enterItem(builder, TX_HASH_BUILDER_IN_VALIDITY_INTERVAL_START);
 	BUILDER_APPEND_CBOR(CBOR_TYPE_UNSIGNED, validityIntervalStart);
-
-	builder->state = TX_HASH_BUILDER_IN_VALIDITY_INTERVAL_START;
-}
-
-static void txHashBuilder_assertCanLeaveValidityIntervalStart(tx_hash_builder_t* builder)
-{
-	_TRACE("state = %d", builder->state);
-
-	switch (builder->state) {
-	case TX_HASH_BUILDER_IN_VALIDITY_INTERVAL_START:
-		// validity interval start was added, we can move on
-		break;
-
-	default:
-		// make sure validity interval start was not expected
-		ASSERT(!builder->includeValidityIntervalStart);
-		// assert we can leave the previous state
-		txHashBuilder_assertCanLeaveAuxData(builder);
-		break;
-	}
 }
 
 // ============================== MINT ==============================
@@ -1440,14 +1399,7 @@ void txHashBuilder_enterMint(tx_hash_builder_t* builder)
 {
 	_TRACE("state = %d", builder->state);
 
-	txHashBuilder_assertCanLeaveValidityIntervalStart(builder);
-	ASSERT(builder->includeMint);
-
-	{
-		// Enter mint
-		BUILDER_APPEND_CBOR(CBOR_TYPE_UNSIGNED, TX_BODY_KEY_MINT);
-	}
-	builder->state = TX_HASH_BUILDER_IN_MINT;
+	txHashBuilder_enterItem(builder, TX_HASH_BUILDER_IN_MINT);
 }
 
 void txHashBuilder_addMint_topLevelData(
@@ -1492,27 +1444,6 @@ void txHashBuilder_addMint_token(
 	         amount < 0 ? CBOR_TYPE_NEGATIVE : CBOR_TYPE_UNSIGNED);
 }
 
-static void txHashBuilder_assertCanLeaveMint(tx_hash_builder_t* builder)
-{
-	_TRACE("state = %u, remainingMintAssetGroups = %u, remainingMintTokens = %u",
-	       builder->state, builder->outputData.multiassetData.remainingAssetGroups, builder->outputData.multiassetData.remainingTokens);
-
-	switch (builder->state) {
-	case TX_HASH_BUILDER_IN_MINT:
-		ASSERT(builder->outputState == TX_OUTPUT_ASSET_GROUP);
-		ASSERT(builder->outputData.multiassetData.remainingAssetGroups == 0);
-		ASSERT(builder->outputData.multiassetData.remainingTokens == 0);
-		break;
-
-	default:
-		// make sure mint was not expected
-		ASSERT(!builder->includeMint);
-		// assert we can leave the previous state
-		txHashBuilder_assertCanLeaveValidityIntervalStart(builder);
-		break;
-	}
-}
-
 // ========================= SCRIPT DATA HASH ==========================
 
 void txHashBuilder_addScriptDataHash(
@@ -1522,34 +1453,13 @@ void txHashBuilder_addScriptDataHash(
 {
 	_TRACE("state = %d", builder->state);
 
-	txHashBuilder_assertCanLeaveMint(builder);
-	ASSERT(builder->includeScriptDataHash);
-
 	ASSERT(scriptHashDataSize == SCRIPT_DATA_HASH_LENGTH);
+
+	txHashBuilder_enterItem(builder, TX_HASH_BUILDER_IN_SCRIPT_DATA_HASH);
 	{
-		BUILDER_APPEND_CBOR(CBOR_TYPE_UNSIGNED, TX_BODY_KEY_SCRIPT_HASH_DATA);
-		BUILDER_APPEND_CBOR(CBOR_TYPE_BYTES, scriptHashDataSize);
+		BUILDER_APPEND_TEMPLATE(TEMPLATE_SCRIPT_DATA_HASH);
 		BUILDER_APPEND_DATA(scriptHashData, scriptHashDataSize);
 	}
-	builder->state = TX_HASH_BUILDER_IN_SCRIPT_DATA_HASH;
-}
-
-static void txHashBuilder_assertCanLeaveScriptDataHash(tx_hash_builder_t* builder)
-{
-	_TRACE("state = %u", builder->state);
-
-	switch (builder->state) {
-	case TX_HASH_BUILDER_IN_SCRIPT_DATA_HASH:
-		// script data hash was added, we can move on
-		break;
-
-	default:
-		// make sure script data hash was not expected
-		ASSERT(!builder->includeScriptDataHash);
-		// assert we can leave the previous state
-		txHashBuilder_assertCanLeaveMint(builder);
-		break;
-	}
 }
 
 // ========================= COLLATERAL INPUTS ==========================
@@ -1558,16 +1468,8 @@ void txHashBuilder_enterCollateralInputs(tx_hash_builder_t* builder)
 {
 	_TRACE("state = %d", builder->state);
 
-	txHashBuilder_assertCanLeaveScriptDataHash(builder);
-	// we don't allow an empty list for an optional item
-	ASSERT(builder->remainingCollateralInputs > 0);
-
-	{
-		// Enter collateral inputs
-		BUILDER_APPEND_CBOR(CBOR_TYPE_UNSIGNED, TX_BODY_KEY_COLLATERAL_INPUTS);
-		BUILDER_APPEND_CBOR(CBOR_TYPE_ARRAY, builder->remainingCollateralInputs);
-	}
-	builder->state = TX_HASH_BUILDER_IN_COLLATERAL_INPUTS;
+	txHashBuilder_enterItem(builder, TX_HASH_BUILDER_IN_COLLATERAL_INPUTS);
+	BUILDER_APPEND_CBOR(CBOR_TYPE_ARRAY, builder->remainingCollateralInputs);
 }
 
 void txHashBuilder_addCollateralInput(tx_hash_builder_t* builder, const tx_input_t* collInput)
@@ -1583,41 +1485,14 @@ void txHashBuilder_addCollateralInput(tx_hash_builder_t* builder, const tx_input
 	cbor_append_txInput(builder, collInput->txHashBuffer, utxoHashSize, collInput->index);
 }
 
-static void txHashBuilder_assertCanLeaveCollateralInputs(tx_hash_builder_t* builder)
-{
-	_TRACE("state = %u", builder->state);
-
-	switch (builder->state) {
-	case TX_HASH_BUILDER_IN_COLLATERAL_INPUTS:
-		// make sure there are no more collateral inputs to process
-		ASSERT(builder->remainingCollateralInputs == 0);
-		break;
-
-	default:
-		// make sure no collateral inputs are expected
-		ASSERT(builder->remainingCollateralInputs == 0);
-		// assert we can leave the previous state
-		txHashBuilder_assertCanLeaveScriptDataHash(builder);
-		break;
-	}
-}
-
 // ========================= REQUIRED SIGNERS ==========================
 
 void txHashBuilder_enterRequiredSigners(tx_hash_builder_t* builder)
 {
 	_TRACE("state = %d", builder->state);
 
-	txHashBuilder_assertCanLeaveCollateralInputs(builder);
-	// we don't allow an empty list for an optional item
-	ASSERT(builder->remainingRequiredSigners > 0);
-
-	{
-		// Enter required signers
-		BUILDER_APPEND_CBOR(CBOR_TYPE_UNSIGNED, TX_BODY_KEY_REQUIRED_SIGNERS);
-		BUILDER_APPEND_CBOR(CBOR_TYPE_ARRAY, builder->remainingRequiredSigners);
-	}
-	builder->state = TX_HASH_BUILDER_IN_REQUIRED_SIGNERS;
+	txHashBuilder_enterItem(builder, TX_HASH_BUILDER_IN_REQUIRED_SIGNERS);
+	BUILDER_APPEND_CBOR(CBOR_TYPE_ARRAY, builder->remainingRequiredSigners);
 }
 
 void txHashBuilder_addRequiredSigner(
@@ -1639,62 +1514,19 @@ void txHashBuilder_addRequiredSigner(
 	// ]
 	{
 		ASSERT(vkeySize == ADDRESS_KEY_HASH_LENGTH);
-		BUILDER_APPEND_CBOR(CBOR_TYPE_BYTES, vkeySize);
+		BUILDER_APPEND_TEMPLATE(TEMPLATE_KEY_HASH);
 		BUILDER_APPEND_DATA(vkeyBuffer, vkeySize);
 	}
 }
 
-static void txHashBuilder_assertCanLeaveRequiredSigners(tx_hash_builder_t* builder)
-{
-	_TRACE("state = %u", builder->state);
-
-	switch (builder->state) {
-	case TX_HASH_BUILDER_IN_REQUIRED_SIGNERS:
-		// make sure there are no more withdrawals to process
-		ASSERT(builder->remainingRequiredSigners == 0);
-		break;
-
-	default:
-		// make sure no required signers are expected
-		ASSERT(builder->remainingRequiredSigners == 0);
-		// assert we can leave the previous state
-		txHashBuilder_assertCanLeaveCollateralInputs(builder);
-		break;
-	}
-}
-
 // ========================= NETWORK ID ==========================
 
 void txHashBuilder_addNetworkId(tx_hash_builder_t* builder, uint8_t networkId)
 {
 	_TRACE("state = %d", builder->state);
 
-	txHashBuilder_assertCanLeaveRequiredSigners(builder);
-	ASSERT(builder->includeNetworkId);
-
-	// add network id item into the main tx body map
-	BUILDER_APPEND_CBOR(CBOR_TYPE_UNSIGNED, TX_BODY_KEY_NETWORK_ID);
+	txHashBuilder_enterItem(builder, TX_HASH_BUILDER_IN_NETWORK_ID);
 	BUILDER_APPEND_CBOR(CBOR_TYPE_UNSIGNED, networkId);
-
-	builder->state = TX_HASH_BUILDER_IN_NETWORK_ID;
-}
-
-static void txHashBuilder_assertCanLeaveNetworkId(tx_hash_builder_t* builder)
-{
-	_TRACE("state = %d", builder->state);
-
-	switch (builder->state) {
-	case TX_HASH_BUILDER_IN_NETWORK_ID:
-		// network id was added, we can move on
-		break;
-
-	default:
-		// make sure network id was not expected
-		ASSERT(!builder->includeNetworkId);
-		// assert we can leave the previous state
-		txHashBuilder_assertCanLeaveRequiredSigners(builder);
-		break;
-	}
 }
 
 // ========================= COLLATERAL RETURN OUTPUT ==========================
@@ -1706,17 +1538,10 @@ void txHashBuilder_addCollateralOutput(
 {
 	_TRACE("state = %d", builder->state);
 
-	txHashBuilder_assertCanLeaveNetworkId(builder);
-	ASSERT(builder->includeCollateralOutput);
-
-	{
-		// Enter collateral output
-		BUILDER_APPEND_CBOR(CBOR_TYPE_UNSIGNED, TX_BODY_KEY_COLLATERAL_OUTPUT);
-	}
+	txHashBuilder_enterItem(builder, TX_HASH_BUILDER_IN_COLLATERAL_OUTPUT);
 	processOutputTopLevel(builder, output);
 
 	builder->outputState = TX_OUTPUT_TOP_LEVEL_DATA;
-	builder->state = TX_HASH_BUILDER_IN_COLLATERAL_OUTPUT;
 }
 
 void txHashBuilder_addCollateralOutput_tokenGroup(
@@ -1741,57 +1566,14 @@ void txHashBuilder_addCollateralOutput_token(
 	addToken(builder, assetNameBuffer, assetNameSize, amount, CBOR_TYPE_UNSIGNED);
 }
 
-static void txHashBuilder_assertCanLeaveCollateralOutput(tx_hash_builder_t* builder)
-{
-	_TRACE("state = %d", builder->state);
-
-	switch (builder->state) {
-	case TX_HASH_BUILDER_IN_COLLATERAL_OUTPUT:
-		assertCanLeaveCurrentOutput(builder);
-		// collateral return output was added, we can move on
-		break;
-
-	default:
-		// make sure collateral return was not expected
-		ASSERT(!builder->includeCollateralOutput);
-		// assert we can leave the previous state
-		txHashBuilder_assertCanLeaveNetworkId(builder);
-		break;
-	}
-}
-
 // ========================= TOTAL COLLATERAL ==========================
 
 void txHashBuilder_addTotalCollateral(tx_hash_builder_t* builder, uint64_t txColl)
 {
 	_TRACE("state = %d", builder->state);
 
-	txHashBuilder_assertCanLeaveCollateralOutput(builder);
-	ASSERT(builder->includeTotalCollateral);
-
-	// add TotalCollateral item into the main tx body map
-	BUILDER_APPEND_CBOR(CBOR_TYPE_UNSIGNED, TX_BODY_KEY_TOTAL_COLLATERAL);
+	txHashBuilder_enterItem(builder, TX_HASH_BUILDER_IN_TOTAL_COLLATERAL);
 	BUILDER_APPEND_CBOR(CBOR_TYPE_UNSIGNED, txColl);
-
-	builder->state = TX_HASH_BUILDER_IN_TOTAL_COLLATERAL;
-}
-
-static void txHashBuilder_assertCanLeaveTotalCollateral(tx_hash_builder_t* builder)
-{
-	_TRACE("state = %d", builder->state);
-
-	switch (builder->state) {
-	case TX_HASH_BUILDER_IN_TOTAL_COLLATERAL:
-		// total collateral was added, we can move on
-		break;
-
-	default:
-		// make sure total collateral was not expected
-		ASSERT(!builder->includeTotalCollateral);
-		// assert we can leave the previous state
-		txHashBuilder_assertCanLeaveCollateralOutput(builder);
-		break;
-	}
 }
 
 // ========================= REFERENCE INPUTS ==========================
@@ -1800,17 +1582,8 @@ void txHashBuilder_enterReferenceInputs(tx_hash_builder_t* builder)
 {
 	_TRACE("state = %d", builder->state);
 
-	txHashBuilder_assertCanLeaveTotalCollateral(builder);
-	// we don't allow an empty list for an optional item
-	ASSERT(builder->remainingReferenceInputs > 0);
-
-	{
-		// Enter reference inputs
-		BUILDER_APPEND_CBOR(CBOR_TYPE_UNSIGNED, TX_BODY_KEY_REFERENCE_INPUTS);
-		BUILDER_APPEND_CBOR(CBOR_TYPE_ARRAY, builder->remainingReferenceInputs);
-	}
-	builder->state = TX_HASH_BUILDER_IN_REFERENCE_INPUTS;
-
+	txHashBuilder_enterItem(builder, TX_HASH_BUILDER_IN_REFERENCE_INPUTS);
+	BUILDER_APPEND_CBOR(CBOR_TYPE_ARRAY, builder->remainingReferenceInputs);
 }
 
 void txHashBuilder_addReferenceInput(
@@ -1830,34 +1603,15 @@ void txHashBuilder_addReferenceInput(
 }
 
 
-static void txHashBuilder_assertCanLeaveReferenceInputs(tx_hash_builder_t* builder)
-{
-	_TRACE("state = %d", builder->state);
-
-	switch (builder->state) {
-	case TX_HASH_BUILDER_IN_REFERENCE_INPUTS:
-		// make sure there are no more reference inputs to process
-		ASSERT(builder->remainingReferenceInputs == 0);
-		break;
-
-	default:
-		// make sure no reference inputs are expected
-		ASSERT(builder->remainingReferenceInputs == 0);
-		// assert we can leave the previous state
-		txHashBuilder_assertCanLeaveTotalCollateral(builder);
-		break;
-	}
-}
-
 // ========================= FINALIZE ==========================
 
 void txHashBuilder_finalize(tx_hash_builder_t* builder, uint8_t* outBuffer, size_t outSize)
 {
-	txHashBuilder_assertCanLeaveReferenceInputs(builder);
+	txHashBuilder_assertCanLeavePrecedingItems(builder, ARRAY_LEN(TX_BODY_ITEM_LIST));
 
 	ASSERT(outSize == TX_HASH_LENGTH);
 	{
-		blake2b_256_finalize(&builder->txHash, outBuffer, outSize);
+		blake2b_256_buffered_finalize(&builder->txHash, outBuffer, outSize);
 	}
 
 	builder->state = TX_HASH_BUILDER_FINISHED;
@@ -2,6 +2,7 @@
 #define H_CARDANO_APP_TX_HASH_BUILDER
 
 #include "cardano.h"
+#include "cbor.h"
 #include "hash.h"
 #include "addressUtilsShelley.h"
 
@@ -72,6 +73,70 @@ enum {
 	TX_OUTPUT_KEY_SCRIPT_REF = 3,
 };
 
+/* Fixed CBOR prefixes of tx body fragments, encoded at build time.
+ * A fragment is appended as one constant prefix followed by its variable fields.
+ */
+
+// Array(2)[ Bytes[txHash] ... (followed by Unsigned[index])
+#define TX_BODY_TEMPLATE_INPUT \
+	CBOR_TOKEN_SMALL(CBOR_TYPE_ARRAY, 2), \
+	CBOR_TOKEN_U8(CBOR_TYPE_BYTES, TX_HASH_LENGTH)
+
+// Array(3)[ Unsigned[2] Array(2)[ ... (followed by the stake credential)
+#define TX_BODY_TEMPLATE_CERTIFICATE_DELEGATION \
+	CBOR_TOKEN_SMALL(CBOR_TYPE_ARRAY, 3), \
+	CBOR_TOKEN_SMALL(CBOR_TYPE_UNSIGNED, CERTIFICATE_TYPE_STAKE_DELEGATION), \
+	CBOR_TOKEN_SMALL(CBOR_TYPE_ARRAY, 2)
+
+// Array(3)[ Unsigned[4] Bytes[poolKeyHash] ... (followed by Unsigned[epoch])
+#define TX_BODY_TEMPLATE_CERTIFICATE_POOL_RETIREMENT \
+	CBOR_TOKEN_SMALL(CBOR_TYPE_ARRAY, 3), \
+	CBOR_TOKEN_SMALL(CBOR_TYPE_UNSIGNED, CERTIFICATE_TYPE_STAKE_POOL_RETIREMENT), \
+	CBOR_TOKEN_U8(CBOR_TYPE_BYTES, POOL_KEY_HASH_LENGTH)
+
+// Array(10)[ Unsigned[3] ... (followed by the pool params)
+#define TX_BODY_TEMPLATE_CERTIFICATE_POOL_REGISTRATION \
+	CBOR_TOKEN_SMALL(CBOR_TYPE_ARRAY, 10), \
+	CBOR_TOKEN_SMALL(CBOR_TYPE_UNSIGNED, CERTIFICATE_TYPE_STAKE_POOL_REGISTRATION)
+
+// Bytes[stakingKeyHash], also used for pool owners and required signers
+#define TX_BODY_TEMPLATE_KEY_HASH \
+	CBOR_TOKEN_U8(CBOR_TYPE_BYTES, ADDRESS_KEY_HASH_LENGTH)
+
+#define TX_BODY_TEMPLATE_POOL_KEY_HASH \
+	CBOR_TOKEN_U8(CBOR_TYPE_BYTES, POOL_KEY_HASH_LENGTH)
+
+#define TX_BODY_TEMPLATE_VRF_KEY_HASH \
+	CBOR_TOKEN_U8(CBOR_TYPE_BYTES, VRF_KEY_HASH_LENGTH)
+
+// Tag(30) Array(2)[ ... (followed by the margin numerator and denominator)
+#define TX_BODY_TEMPLATE_POOL_MARGIN \
+	CBOR_TOKEN_U8(CBOR_TYPE_TAG, 30), \
+	CBOR_TOKEN_SMALL(CBOR_TYPE_ARRAY, 2)
+
+// Bytes[rewardAccount], also used for withdrawals
+#define TX_BODY_TEMPLATE_REWARD_ACCOUNT \
+	CBOR_TOKEN_U8(CBOR_TYPE_BYTES, REWARD_ACCOUNT_SIZE)
+
+#define TX_BODY_TEMPLATE_POOL_METADATA_HASH \
+	CBOR_TOKEN_U8(CBOR_TYPE_BYTES, POOL_METADATA_HASH_LENGTH)
+
+#define TX_BODY_TEMPLATE_AUX_DATA \
+	CBOR_TOKEN_U8(CBOR_TYPE_BYTES, AUX_DATA_HASH_LENGTH)
+
+#define TX_BODY_TEMPLATE_SCRIPT_DATA_HASH \
+	CBOR_TOKEN_U8(CBOR_TYPE_BYTES, SCRIPT_DATA_HASH_LENGTH)
+
+#define TX_BODY_TEMPLATE_POLICY_ID \
+	CBOR_TOKEN_U8(CBOR_TYPE_BYTES, MINTING_POLICY_ID_SIZE)
+
+#define TX_BODY_TEMPLATE_DATUM_HASH \
+	CBOR_TOKEN_U8(CBOR_TYPE_BYTES, OUTPUT_DATUM_HASH_LENGTH)
+
+// Tag(24) followed by Bytes[...] of variable size
+#define TX_BODY_TEMPLATE_EMBEDDED_CBOR \
+	CBOR_TOKEN_U8(CBOR_TYPE_TAG, CBOR_TAG_EMBEDDED_CBOR_BYTE_STRING)
+
 /* The state machine of the tx hash builder is driven by user calls.
  * E.g., when the user calls txHashBuilder_addInput(), the input is only
  * added and the state is not advanced to outputs even if all inputs have been added
@@ -170,7 +235,7 @@ typedef struct {
 
 
 	tx_hash_builder_state_t state;
-	blake2b_256_context_t txHash;
+	blake2b_256_buffered_context_t txHash;
 } tx_hash_builder_t;
 
 typedef struct {
@@ -2,6 +2,7 @@
 
 #include "txHashBuilder.h"
 #include "cardano.h"
+#include "cbor.h"
 #include "hexUtils.h"
 #include "textUtils.h"
 #include "testUtils.h"
@@ -439,9 +440,81 @@ static void addCertificates(tx_hash_builder_t* builder)
 	}
 }
 
+// the tokens a template is expected to consist of
+typedef struct {
+	uint8_t type;
+	uint64_t value;
+} template_token_t;
+
+static void testTemplate(
+        const uint8_t* template, size_t templateSize,
+        const template_token_t* tokens, size_t numTokens
+)
+{
+	uint8_t expected[30] = {0};
+	size_t size = 0;
+	for (size_t i = 0; i < numTokens; i++) {
+		size += cbor_writeToken(tokens[i].type, tokens[i].value, expected + size, SIZEOF(expected) - size);
+	}
+	EXPECT_EQ(templateSize, size);
+	EXPECT_EQ_BYTES(template, expected, size);
+}
+
+// sizeof since SIZEOF does not work for 4-byte buffers
+#define TEST_TEMPLATE(templateBytes, ...) \
+	do { \
+		const uint8_t template[] = {templateBytes}; \
+		const template_token_t tokens[] = {__VA_ARGS__}; \
+		testTemplate(template, sizeof(template), tokens, ARRAY_LEN(tokens)); \
+	} while (0)
+
+static void testTemplates()
+{
+	PRINTF("txHashBuilder templates test\n");
+
+	// boundaries of the build-time token encoding
+	TEST_TEMPLATE(CBOR_TOKEN_SMALL(CBOR_TYPE_UNSIGNED, 0), {CBOR_TYPE_UNSIGNED, 0});
+	TEST_TEMPLATE(CBOR_TOKEN_SMALL(CBOR_TYPE_ARRAY, 23), {CBOR_TYPE_ARRAY, 23});
+	TEST_TEMPLATE(CBOR_TOKEN_U8(CBOR_TYPE_BYTES, 24), {CBOR_TYPE_BYTES, 24});
+	TEST_TEMPLATE(CBOR_TOKEN_U8(CBOR_TYPE_TAG, 255), {CBOR_TYPE_TAG, 255});
+
+	TEST_TEMPLATE(
+	        TX_BODY_TEMPLATE_INPUT,
+	        {CBOR_TYPE_ARRAY, 2}, {CBOR_TYPE_BYTES, TX_HASH_LENGTH}
+	);
+	TEST_TEMPLATE(
+	        TX_BODY_TEMPLATE_CERTIFICATE_DELEGATION,
+	        {CBOR_TYPE_ARRAY, 3}, {CBOR_TYPE_UNSIGNED, 2}, {CBOR_TYPE_ARRAY, 2}
+	);
+	TEST_TEMPLATE(
+	        TX_BODY_TEMPLATE_CERTIFICATE_POOL_RETIREMENT,
+	        {CBOR_TYPE_ARRAY, 3}, {CBOR_TYPE_UNSIGNED, 4}, {CBOR_TYPE_BYTES, POOL_KEY_HASH_LENGTH}
+	);
+	TEST_TEMPLATE(
+	        TX_BODY_TEMPLATE_CERTIFICATE_POOL_REGISTRATION,
+	        {CBOR_TYPE_ARRAY, 10}, {CBOR_TYPE_UNSIGNED, 3}
+	);
+	TEST_TEMPLATE(TX_BODY_TEMPLATE_KEY_HASH, {CBOR_TYPE_BYTES, ADDRESS_KEY_HASH_LENGTH});
+	TEST_TEMPLATE(TX_BODY_TEMPLATE_POOL_KEY_HASH, {CBOR_TYPE_BYTES, POOL_KEY_HASH_LENGTH});
+	TEST_TEMPLATE(TX_BODY_TEMPLATE_VRF_KEY_HASH, {CBOR_TYPE_BYTES, VRF_KEY_HASH_LENGTH});
+	TEST_TEMPLATE(TX_BODY_TEMPLATE_POOL_MARGIN, {CBOR_TYPE_TAG, 30}, {CBOR_TYPE_ARRAY, 2});
+	TEST_TEMPLATE(TX_BODY_TEMPLATE_REWARD_ACCOUNT, {CBOR_TYPE_BYTES, REWARD_ACCOUNT_SIZE});
+	TEST_TEMPLATE(TX_BODY_TEMPLATE_POOL_METADATA_HASH, {CBOR_TYPE_BYTES, POOL_METADATA_HASH_LENGTH});
+	TEST_TEMPLATE(TX_BODY_TEMPLATE_AUX_DATA, {CBOR_TYPE_BYTES, AUX_DATA_HASH_LENGTH});
+	TEST_TEMPLATE(TX_BODY_TEMPLATE_SCRIPT_DATA_HASH, {CBOR_TYPE_BYTES, SCRIPT_DATA_HASH_LENGTH});
+	TEST_TEMPLATE(TX_BODY_TEMPLATE_POLICY_ID, {CBOR_TYPE_BYTES, MINTING_POLICY_ID_SIZE});
+	TEST_TEMPLATE(TX_BODY_TEMPLATE_DATUM_HASH, {CBOR_TYPE_BYTES, OUTPUT_DATUM_HASH_LENGTH});
+	TEST_TEMPLATE(
+	        TX_BODY_TEMPLATE_EMBEDDED_CBOR,
+	        {CBOR_TYPE_TAG, CBOR_TAG_EMBEDDED_CBOR_BYTE_STRING}
+	);
+}
+
 void run_txHashBuilder_test()
 {
 	PRINTF("txHashBuilder test\n");
+	testTemplates();
+
 	tx_hash_builder_t builder;
 
 	const size_t numCertificates = ARRAY_LEN(registrationCertificates) +
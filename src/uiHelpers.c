@@ -6,6 +6,7 @@
 #include "io.h"
 #include "utils.h"
 #include "securityPolicy.h"
+#include "backgroundTasks.h"
 
 displayState_t displayState;
 
@@ -35,6 +36,16 @@ void assert_uiPrompt_magic()
 	ASSERT(promptState->initMagic == INIT_MAGIC_PROMPT);
 }
 
+static void _runCallback(ui_callback_fn_t* callback)
+{
+	if (backgroundTasks_isSliceRunning()) {
+		// the user is faster than the background task, see backgroundTasks.h
+		backgroundTasks_deferCallback(callback);
+		return;
+	}
+	callback();
+}
+
 void uiCallback_confirm(ui_callback_t* cb)
 {
 	if (!cb->confirm) return;
@@ -43,7 +54,7 @@ void uiCallback_confirm(ui_callback_t* cb)
 	case CALLBACK_NOT_RUN:
 		// Note: needs to be done before resolving in case it throws
 		cb->state = CALLBACK_RUN;
-		cb->confirm();
+		_runCallback(cb->confirm);
 		break;
 	case CALLBACK_RUN:
 		// Ignore
@@ -61,7 +72,7 @@ void uiCallback_reject(ui_callback_t* cb)
 	case CALLBACK_NOT_RUN:
 		// Note: needs to be done before resolving in case it throws
 		cb->state = CALLBACK_RUN;
-		cb->reject();
+		_runCallback(cb->reject);
 		break;
 	case CALLBACK_RUN:
 		// Ignore
@@ -26,13 +26,13 @@ The following macros and functions have dual purpose:
 
 
 static void blake2b_256_append_buffer_tx_body(
-        blake2b_256_context_t* hashCtx,
+        blake2b_256_buffered_context_t* hashCtx,
         const uint8_t* buffer,
         size_t bufferSize
 )
 {
 	TRACE_BUFFER(buffer, bufferSize);
-	blake2b_256_append(hashCtx, buffer, bufferSize);
+	blake2b_256_buffered_append(hashCtx, buffer, bufferSize);
 }
 
 /* End of hash computation utilities. */
@@ -49,7 +49,7 @@ void votecastHashBuilder_init(
 	ASSERT(remainingBytes > 0);
 	builder->remainingBytes = remainingBytes;
 
-	blake2b_256_init(&builder->hash);
+	blake2b_256_buffered_init(&builder->hash);
 
 	builder->state = VOTECAST_HASH_BUILDER_INIT;
 }
@@ -92,7 +92,7 @@ void votecastHashBuilder_finalize(
 
 	ASSERT(outSize == VOTECAST_HASH_LENGTH);
 	{
-		blake2b_256_finalize(&builder->hash, outBuffer, outSize);
+		blake2b_256_buffered_finalize(&builder->hash, outBuffer, outSize);
 	}
 
 	builder->state = VOTECAST_HASH_BUILDER_FINISHED;
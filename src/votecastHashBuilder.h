@@ -16,7 +16,7 @@ typedef struct {
 
 	size_t remainingBytes;
 
-	blake2b_256_context_t hash;
+	blake2b_256_buffered_context_t hash;
 } votecast_hash_builder_t;
 
 void votecastHashBuilder_init(
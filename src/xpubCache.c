@@ -0,0 +1,282 @@
+#include "xpubCache.h"
+#include "backgroundTasks.h"
+
+#if defined(TARGET_NANOX) || defined(TARGET_NANOS2)
+#define NV_CONST const
+#define NV_VOLATILE volatile
+#else
+#define NV_CONST
+#define NV_VOLATILE
+#endif
+
+#if defined (TARGET_NANOS) || defined(TARGET_NANOX) || defined(TARGET_NANOS2)
+#define MEMCPY_NV nvm_write
+#else
+#define MEMCPY_NV memcpy
+#endif
+
+typedef struct {
+	// written separately before and after the rest of the entry
+	// so that an interrupted write does not leave an inconsistent key behind
+	uint8_t isValid;
+	uint32_t path[XPUB_CACHE_PATH_LENGTH];
+	extendedPublicKey_t extPubKey;
+} xpub_cache_entry_t;
+
+typedef struct {
+	// zero after installation, i.e. the cache is enabled by default
+	uint8_t disabled;
+	uint8_t nextEntry; // the oldest one is replaced when full
+	uint8_t seedFingerprint[XPUB_CACHE_FINGERPRINT_LENGTH];
+} xpub_cache_header_t;
+
+typedef struct {
+	xpub_cache_header_t header;
+	xpub_cache_entry_t entries[XPUB_CACHE_SIZE];
+} xpub_cache_persistent_t;
+
+#if defined(TARGET_NANOS) || defined(TARGET_NANOX) || defined(TARGET_NANOS2)
+xpub_cache_persistent_t NV_CONST N_xpubCache_impl __attribute__ ((aligned(64)));
+#define N_xpubCache (*(NV_VOLATILE xpub_cache_persistent_t *)PIC(&N_xpubCache_impl))
+#else
+xpub_cache_persistent_t N_xpubCache_impl;
+#define N_xpubCache N_xpubCache_impl
+#endif
+
+// the seed cannot change while the app is running
+static struct {
+	bool isComputed;
+	uint8_t value[XPUB_CACHE_FINGERPRINT_LENGTH];
+} seedFingerprint;
+
+// the chain code of the first Shelley account is a part of its (public) extended key
+// and unlike the public key, it is obtained without a scalar multiplication
+static void _getFingerprintPath(bip44_path_t* pathSpec)
+{
+	explicit_bzero(pathSpec, SIZEOF(*pathSpec));
+	pathSpec->path[BIP44_I_PURPOSE] = harden(PURPOSE_SHELLEY);
+	pathSpec->path[BIP44_I_COIN_TYPE] = harden(ADA_COIN_TYPE);
+	pathSpec->path[BIP44_I_ACCOUNT] = harden(0);
+	pathSpec->length = XPUB_CACHE_PATH_LENGTH;
+}
+
+static void _setSeedFingerprint(const uint8_t* chainCode, size_t chainCodeSize)
+{
+	blake2b_224_hash(
+	        chainCode, chainCodeSize,
+	        seedFingerprint.value, SIZEOF(seedFingerprint.value)
+	);
+	seedFingerprint.isComputed = true;
+}
+
+static const uint8_t* _getSeedFingerprint()
+{
+	if (seedFingerprint.isComputed) {
+		return seedFingerprint.value;
+	}
+
+	bip44_path_t pathSpec;
+	_getFingerprintPath(&pathSpec);
+
+	chain_code_t chainCode;
+	privateKey_t privateKey;
+
+	BEGIN_TRY {
+		TRY {
+			derivePrivateKey(&pathSpec, &chainCode, &privateKey);
+			_setSeedFingerprint(chainCode.code, SIZEOF(chainCode.code));
+		}
+		FINALLY {
+			explicit_bzero(&privateKey, SIZEOF(privateKey));
+			explicit_bzero(&chainCode, SIZEOF(chainCode));
+		}
+	} END_TRY;
+
+	return seedFingerprint.value;
+}
+
+// a key derived in a background slice, waiting to be written to NVM
+static struct {
+	bool isPending;
+	bip44_path_t pathSpec;
+	extendedPublicKey_t extPubKey;
+} pendingStore;
+
+// m/purpose'/coin_type'/account'
+static bool _isAccountPath(const bip44_path_t* pathSpec)
+{
+	if (pathSpec->length != XPUB_CACHE_PATH_LENGTH) return false;
+
+	for (size_t i = 0; i < XPUB_CACHE_PATH_LENGTH; i++) {
+		if (!isHardened(pathSpec->path[i])) return false;
+	}
+	return true;
+}
+
+static void _readHeader(xpub_cache_header_t* header)
+{
+	memmove(header, (const void*) &N_xpubCache.header, SIZEOF(*header));
+}
+
+static void _writeHeader(const xpub_cache_header_t* header)
+{
+	MEMCPY_NV((void*) &N_xpubCache.header, (void*) header, sizeof(*header));
+}
+
+// needs a derivation from the seed in the first call of the app run
+static bool _isBoundToCurrentSeed()
+{
+	xpub_cache_header_t header;
+	_readHeader(&header);
+
+	return memcmp(header.seedFingerprint, _getSeedFingerprint(), SIZEOF(header.seedFingerprint)) == 0;
+}
+
+static void _writeEntryValidity(size_t i, uint8_t isValid)
+{
+	ASSERT(i < XPUB_CACHE_SIZE);
+	MEMCPY_NV((void*) &N_xpubCache.entries[i].isValid, (void*) &isValid, sizeof(isValid));
+}
+
+static void _writeEntry(size_t i, const xpub_cache_entry_t* entry)
+{
+	ASSERT(i < XPUB_CACHE_SIZE);
+	MEMCPY_NV((void*) &N_xpubCache.entries[i], (void*) entry, sizeof(*entry));
+}
+
+static void _clearEntries()
+{
+	xpub_cache_entry_t entry;
+	explicit_bzero(&entry, SIZEOF(entry));
+
+	for (size_t i = 0; i < XPUB_CACHE_SIZE; i++) {
+		_writeEntry(i, &entry);
+	}
+}
+
+bool xpubCache_isEnabled()
+{
+	return !N_xpubCache.header.disabled;
+}
+
+void xpubCache_setEnabled(bool enabled)
+{
+	if (!enabled) {
+		xpubCache_clear();
+	}
+
+	xpub_cache_header_t header;
+	_readHeader(&header);
+	header.disabled = !enabled;
+	_writeHeader(&header);
+}
+
+void xpubCache_clear()
+{
+	TRACE("Clearing xpub cache");
+
+	explicit_bzero(&pendingStore, SIZEOF(pendingStore));
+
+	_clearEntries();
+
+	xpub_cache_header_t header;
+	_readHeader(&header);
+	header.nextEntry = 0;
+	explicit_bzero(header.seedFingerprint, SIZEOF(header.seedFingerprint));
+	_writeHeader(&header);
+}
+
+bool xpubCache_get(const bip44_path_t* pathSpec, extendedPublicKey_t* out)
+{
+	if (!_isAccountPath(pathSpec)) return false;
+	if (!xpubCache_isEnabled()) return false;
+
+	for (size_t i = 0; i < XPUB_CACHE_SIZE; i++) {
+		if (!N_xpubCache.entries[i].isValid) continue;
+
+		bool matches = true;
+		for (size_t j = 0; j < XPUB_CACHE_PATH_LENGTH; j++) {
+			matches = matches && (N_xpubCache.entries[i].path[j] == pathSpec->path[j]);
+		}
+		if (!matches) continue;
+
+		// validated only on a hit, a miss does not pay for the seed fingerprint
+		if (!_isBoundToCurrentSeed()) return false;
+
+		memmove(out, (const void*) &N_xpubCache.entries[i].extPubKey, SIZEOF(*out));
+		return true;
+	}
+	return false;
+}
+
+static void _store(const bip44_path_t* pathSpec, const extendedPublicKey_t* extPubKey)
+{
+	// the key has just been derived, no need to derive the fingerprint again
+	bip44_path_t fingerprintPath;
+	_getFingerprintPath(&fingerprintPath);
+	if (!seedFingerprint.isComputed && bip44_pathsEqual(pathSpec, &fingerprintPath)) {
+		_setSeedFingerprint(extPubKey->chainCode, SIZEOF(extPubKey->chainCode));
+	}
+
+	xpub_cache_header_t header;
+	_readHeader(&header);
+
+	const uint8_t* fingerprint = _getSeedFingerprint();
+	if (memcmp(header.seedFingerprint, fingerprint, SIZEOF(header.seedFingerprint)) != 0) {
+		TRACE("Seed changed, clearing xpub cache");
+		_clearEntries();
+		header.nextEntry = 0;
+		memmove(header.seedFingerprint, fingerprint, SIZEOF(header.seedFingerprint));
+		_writeHeader(&header);
+	}
+
+	// sanity, the value comes from NVM
+	header.nextEntry = (uint8_t) (header.nextEntry % XPUB_CACHE_SIZE);
+
+	xpub_cache_entry_t entry;
+	explicit_bzero(&entry, SIZEOF(entry));
+	entry.isValid = false;
+	STATIC_ASSERT(SIZEOF(entry.path) == XPUB_CACHE_PATH_LENGTH * sizeof(pathSpec->path[0]), "bad path size");
+	memmove(entry.path, pathSpec->path, SIZEOF(entry.path));
+	entry.extPubKey = *extPubKey;
+
+	_writeEntryValidity(header.nextEntry, false);
+	_writeEntry(header.nextEntry, &entry);
+	_writeEntryValidity(header.nextEntry, true);
+
+	header.nextEntry = (uint8_t) ((header.nextEntry + 1) % XPUB_CACHE_SIZE);
+	_writeHeader(&header);
+}
+
+void xpubCache_store(const bip44_path_t* pathSpec, const extendedPublicKey_t* extPubKey)
+{
+	if (!_isAccountPath(pathSpec)) return;
+	if (!xpubCache_isEnabled()) return;
+
+	if (backgroundTasks_isSliceRunning()) {
+		// only the last one is kept, a slice derives at most one account key
+		pendingStore.pathSpec = *pathSpec;
+		pendingStore.extPubKey = *extPubKey;
+		pendingStore.isPending = true;
+		return;
+	}
+
+	_store(pathSpec, extPubKey);
+}
+
+void xpubCache_storePending()
+{
+	ASSERT(!backgroundTasks_isSliceRunning());
+
+	if (!pendingStore.isPending) return;
+
+	// cleared first so that a failing write is not retried on every APDU
+	const bip44_path_t pathSpec = pendingStore.pathSpec;
+	const extendedPublicKey_t extPubKey = pendingStore.extPubKey;
+	explicit_bzero(&pendingStore, SIZEOF(pendingStore));
+
+	// the cache might have been disabled meanwhile
+	if (!xpubCache_isEnabled()) return;
+
+	_store(&pathSpec, &extPubKey);
+}
@@ -0,0 +1,50 @@
+#ifndef H_CARDANO_APP_XPUB_CACHE
+#define H_CARDANO_APP_XPUB_CACHE
+
+#include "common.h"
+#include "bip44.h"
+#include "keyDerivation.h"
+#include "hash.h"
+
+// Keeps extended public keys of account nodes (m/purpose'/coin_type'/account')
+// in NVM, so that they survive restarts of the app. Only public data are stored.
+//
+// The cache is bound to a fingerprint of the seed and it is ignored (and eventually
+// overwritten) after a change of the seed. The fingerprint needs a derivation from the seed,
+// so it is computed lazily, at most once per app run: on the first hit or the first store.
+// It can be disabled (and thus cleared) in the settings.
+
+#if defined(TARGET_NANOS)
+#define XPUB_CACHE_SIZE 8
+#else
+#define XPUB_CACHE_SIZE 16
+#endif
+
+#define XPUB_CACHE_PATH_LENGTH 3
+#define XPUB_CACHE_FINGERPRINT_LENGTH BLAKE2B_224_SIZE
+
+bool xpubCache_isEnabled();
+
+// disabling the cache clears it
+void xpubCache_setEnabled(bool enabled);
+
+// returns false if the key is not in the cache (or the path is not an account path)
+bool xpubCache_get(const bip44_path_t* pathSpec, extendedPublicKey_t* out);
+
+// does nothing if the cache is disabled or the path is not an account path
+//
+// NVM is not written from a background slice (it runs from a UI event),
+// the key is kept in RAM and stored by xpubCache_storePending instead
+void xpubCache_store(const bip44_path_t* pathSpec, const extendedPublicKey_t* extPubKey);
+
+// supposed to be called when an APDU is being processed
+void xpubCache_storePending();
+
+void xpubCache_clear();
+
+
+#ifdef DEVEL
+void run_xpubCache_test();
+#endif // DEVEL
+
+#endif // H_CARDANO_APP_XPUB_CACHE
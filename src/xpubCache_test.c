@@ -0,0 +1,112 @@
+#ifdef DEVEL
+
+#include "xpubCache.h"
+#include "testUtils.h"
+
+// not a path of a real key (the cache is not cleared if a test fails)
+static void pathSpec_init(bip44_path_t* pathSpec, uint32_t account)
+{
+	const uint32_t path[] = {HARDENED_BIP32 + 999, HARDENED_BIP32 + 999, HARDENED_BIP32 + account};
+	pathSpec->length = ARRAY_LEN(path);
+	memmove(pathSpec->path, path, SIZEOF(path));
+}
+
+// not a real key, the cache does not check it
+static void extPubKey_init(extendedPublicKey_t* extPubKey, uint32_t account)
+{
+	memset(extPubKey, (int) (account + 1), SIZEOF(*extPubKey));
+}
+
+static void testStoredKeys()
+{
+	PRINTF("testcase_xpubCache\n");
+	xpubCache_clear();
+
+	bip44_path_t pathSpec;
+	pathSpec_init(&pathSpec, 7);
+	extendedPublicKey_t expected, extPubKey;
+	extPubKey_init(&expected, 7);
+
+	EXPECT_EQ(xpubCache_get(&pathSpec, &extPubKey), false);
+	xpubCache_store(&pathSpec, &expected);
+	EXPECT_EQ(xpubCache_get(&pathSpec, &extPubKey), true);
+	EXPECT_EQ_BYTES(&extPubKey, &expected, SIZEOF(expected));
+
+	// another account
+	pathSpec_init(&pathSpec, 8);
+	EXPECT_EQ(xpubCache_get(&pathSpec, &extPubKey), false);
+
+	// not an account path
+	const uint32_t path[] = {HARDENED_BIP32 + 999, HARDENED_BIP32 + 999, HARDENED_BIP32 + 7, 0, 0};
+	pathSpec.length = ARRAY_LEN(path);
+	memmove(pathSpec.path, path, SIZEOF(path));
+	xpubCache_store(&pathSpec, &expected);
+	EXPECT_EQ(xpubCache_get(&pathSpec, &extPubKey), false);
+
+	xpubCache_clear();
+	pathSpec_init(&pathSpec, 7);
+	EXPECT_EQ(xpubCache_get(&pathSpec, &extPubKey), false);
+}
+
+static void testReplacement()
+{
+	PRINTF("testcase_xpubCache replacement\n");
+	xpubCache_clear();
+
+	bip44_path_t pathSpec;
+	extendedPublicKey_t extPubKey;
+	// one more account than fits, the first one gets replaced
+	for (uint32_t i = 0; i <= XPUB_CACHE_SIZE; i++) {
+		pathSpec_init(&pathSpec, i);
+		extPubKey_init(&extPubKey, i);
+		xpubCache_store(&pathSpec, &extPubKey);
+	}
+
+	pathSpec_init(&pathSpec, 0);
+	EXPECT_EQ(xpubCache_get(&pathSpec, &extPubKey), false);
+
+	for (uint32_t i = 1; i <= XPUB_CACHE_SIZE; i++) {
+		pathSpec_init(&pathSpec, i);
+		extendedPublicKey_t expected;
+		extPubKey_init(&expected, i);
+		EXPECT_EQ(xpubCache_get(&pathSpec, &extPubKey), true);
+		EXPECT_EQ_BYTES(&extPubKey, &expected, SIZEOF(expected));
+	}
+
+	xpubCache_clear();
+}
+
+static void testDisabled()
+{
+	PRINTF("testcase_xpubCache disabled\n");
+	const bool wasEnabled = xpubCache_isEnabled();
+
+	bip44_path_t pathSpec;
+	pathSpec_init(&pathSpec, 7);
+	extendedPublicKey_t extPubKey;
+	extPubKey_init(&extPubKey, 7);
+
+	xpubCache_setEnabled(true);
+	xpubCache_store(&pathSpec, &extPubKey);
+	EXPECT_EQ(xpubCache_get(&pathSpec, &extPubKey), true);
+
+	// disabling clears the cache
+	xpubCache_setEnabled(false);
+	EXPECT_EQ(xpubCache_isEnabled(), false);
+	EXPECT_EQ(xpubCache_get(&pathSpec, &extPubKey), false);
+	xpubCache_store(&pathSpec, &extPubKey);
+	xpubCache_setEnabled(true);
+	EXPECT_EQ(xpubCache_get(&pathSpec, &extPubKey), false);
+
+	xpubCache_clear();
+	xpubCache_setEnabled(wasEnabled);
+}
+
+void run_xpubCache_test()
+{
+	testStoredKeys();
+	testReplacement();
+	testDisabled();
+}
+
+#endif // DEVEL
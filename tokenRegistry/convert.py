@@ -1,3 +1,4 @@
+
 # converts entries from Cardano Token Registry (json) into code in C used in the app
 
 import json
@@ -6,8 +7,19 @@ import hashlib
 # WARNING --- make sure that:
 #     1. token tickers are meaningful and none is "(unknown decimals)"
 #     2. buffers (e.g. tokenAmountStr) are big enough to hold the tickers
+#     3. tokens in the json are ordered by popularity (Nano S only gets the most popular ones)
 filename = "tokenList.json"
 
+# must match tokens.c
+FINGERPRINT_SIZE = 20
+FINGERPRINT_PREFIX_SIZE = 4
+TICKER_LENGTH_MAX = 15 # stored in a nibble
+DECIMALS_MAX = 15 # stored in a nibble
+TICKER_POOL_SIZE_MAX = 0xFFFF # addressed by 16-bit offsets
+
+# the flash of Nano S is too small for a registry of thousands of tokens
+NANOS_TOKENS_MAX = 128
+
 registry = json.load(open(filename))
 
 def formatHexByte(b):
@@ -16,31 +28,84 @@ def formatHexByte(b):
 def bytestringToC(bstr):
 	return "{ " + ", ".join([formatHexByte(b) for b in bstr]) + " }"
 
-def tokenLine(tokenEntry):
+def tokenFingerprint(tokenEntry):
 	subject = bytes.fromhex(tokenEntry["assetSubject"])
-	fingerprint = hashlib.blake2b(subject, digest_size=20).digest()
-
-	policyId = subject[0:28]
-	assetName = subject[28:]
-	#print(f"{policyId.hex()},   {assetName.hex()},   {fingerprint.hex()},   {bytestringToC(policyId)},   {bytestringToC(assetName)}")
+	return hashlib.blake2b(subject, digest_size=FINGERPRINT_SIZE).digest()
 
+def tokenTicker(tokenEntry):
 	if "ticker" in tokenEntry and len(tokenEntry["ticker"]) > 0:
 		ticker = tokenEntry["ticker"]
 	else:
 		ticker = tokenEntry["name"]
+	# no backslash, so that the ticker can be put into C strings and comments as it is
+	assert ticker.isascii() and ticker.isprintable() and "\\" not in ticker, f"unsupported ticker {ticker}"
+	assert 0 < len(ticker) <= TICKER_LENGTH_MAX, f"ticker {ticker} too long"
+	return ticker
+
+def tickerPool(tokens):
+	# tickers are concatenated without terminators, equal tickers are stored only once
+	pool = ""
+	offsets = {}
+	for t in tokens:
+		ticker = tokenTicker(t)
+		if ticker not in offsets:
+			offsets[ticker] = len(pool)
+			pool += ticker
+	assert len(pool) <= TICKER_POOL_SIZE_MAX, "ticker pool too large"
+	return pool, offsets
+
+def stringToC(s, indent, width = 96):
+	chunks = [s[i:i + width] for i in range(0, len(s), width)]
+	return "\n".join([indent + '"' + chunk.replace('"', '\\"') + '"' for chunk in chunks])
 
-	line = "{ "
-	line += bytestringToC(fingerprint)
+def recordLine(tokenEntry, tickerOffsets):
+	fingerprint = tokenFingerprint(tokenEntry)
+	ticker = tokenTicker(tokenEntry)
+	decimals = tokenEntry["decimals"]
+	assert 0 <= decimals <= DECIMALS_MAX, f"{ticker} has too many decimal places"
+
+	offset = tickerOffsets[ticker]
+	line = "\t{ "
+	line += bytestringToC(fingerprint[FINGERPRINT_PREFIX_SIZE:])
 	line += ", "
-	line += str(tokenEntry["decimals"])
+	line += bytestringToC(offset.to_bytes(2, "big"))
 	line += ", "
-	line += '"' + ticker + '"'
-	line += " }"
+	line += formatHexByte((decimals << 4) | len(ticker))
+	line += " }, // " + ticker
 	return line
 
-allLines = ",\n".join([tokenLine(t) for t in registry])
+def registryCode(tokens, description):
+	# the app looks tokens up by a binary search over fingerprints
+	tokens = sorted(tokens, key=tokenFingerprint)
+	fingerprints = [tokenFingerprint(t) for t in tokens]
+	assert len(set(fingerprints)) == len(fingerprints), "duplicate tokens in the registry"
 
-outputFile = open('token_data.c', 'w')
-outputFile.write(allLines)
-outputFile.write('\n')
+	pool, tickerOffsets = tickerPool(tokens)
+	prefixLines = [
+	        "\t" + bytestringToC(fp[:FINGERPRINT_PREFIX_SIZE]) + "," for fp in fingerprints
+	]
+	recordLines = [recordLine(t, tickerOffsets) for t in tokens]
+
+	recordSize = FINGERPRINT_SIZE + 2 + 1
+	totalSize = len(tokens) * recordSize + len(pool)
+	stats = f"{len(tokens)} tokens, {totalSize} bytes ({totalSize / len(tokens):.1f} per token)"
+	print(f"{description}: {stats}")
 
+	code = f"// {description}: {stats}\n\n"
+	code += "static const char tokenTickers[] =\n" + stringToC(pool, "\t") + ";\n\n"
+	code += "static const uint8_t tokenFingerprintPrefixes[][TOKEN_FINGERPRINT_PREFIX_SIZE] = {\n"
+	code += "\n".join(prefixLines) + "\n};\n\n"
+	code += "static const token_record_t tokenRecords[] = {\n"
+	code += "\n".join(recordLines) + "\n};\n"
+	return code
+
+outputFile = open('token_data.c', 'w')
+outputFile.write("// generated by tokenRegistry/convert.py from " + filename + "\n\n")
+if len(registry) > NANOS_TOKENS_MAX:
+	outputFile.write("#if defined(TARGET_NANOS)\n\n")
+	outputFile.write(registryCode(registry[:NANOS_TOKENS_MAX], "the most popular tokens"))
+	outputFile.write("\n#else\n\n")
+	outputFile.write(registryCode(registry, "all tokens"))
+	outputFile.write("\n#endif\n")
+else:
+	outputFile.write(registryCode(registry, "all tokens"))